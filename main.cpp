@@ -7,11 +7,786 @@
 #include <ctime>
 #include <algorithm>
 #include <stdexcept>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <new>
+#include <iterator>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <list>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <filesystem>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
 
 using namespace std;
 
 // helpers
 
+// stream buffer that drops everything, for running menus/reports without console output
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// Log-linear latency histogram (16 sub-buckets per power of two, roughly 6% precision).
+// Counters are relaxed atomics so several threads can record into one histogram.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 61 * SUB_BUCKETS;
+    atomic<unsigned long long> counts[BUCKETS];
+    atomic<unsigned long long> total;
+    atomic<unsigned long long> sumNs;
+    atomic<unsigned long long> maxNs;
+
+    static int highestBit(unsigned long long v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(v);
+#else
+        int b = 0;
+        while (v >>= 1) ++b;
+        return b;
+#endif
+    }
+
+    static int bucketFor(unsigned long long ns) {
+        if (ns < SUB_BUCKETS) return (int)ns;
+        int e = highestBit(ns);
+        return (e - 3) * SUB_BUCKETS + (int)((ns >> (e - 4)) & (SUB_BUCKETS - 1));
+    }
+
+    static unsigned long long bucketLow(int index) {
+        if (index < SUB_BUCKETS) return (unsigned long long)index;
+        int e = index / SUB_BUCKETS + 3;
+        return (unsigned long long)(SUB_BUCKETS + index % SUB_BUCKETS) << (e - 4);
+    }
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        for (auto& c : counts) c.store(0, memory_order_relaxed);
+        total.store(0, memory_order_relaxed);
+        sumNs.store(0, memory_order_relaxed);
+        maxNs.store(0, memory_order_relaxed);
+    }
+
+    void record(unsigned long long ns) {
+        counts[bucketFor(ns)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        sumNs.fetch_add(ns, memory_order_relaxed);
+        unsigned long long prev = maxNs.load(memory_order_relaxed);
+        while (ns > prev && !maxNs.compare_exchange_weak(prev, ns, memory_order_relaxed)) {}
+    }
+
+    unsigned long long count() const { return total.load(memory_order_relaxed); }
+    unsigned long long maxValue() const { return maxNs.load(memory_order_relaxed); }
+    double mean() const { return count() ? (double)sumNs.load(memory_order_relaxed) / count() : 0.0; }
+
+    // value at quantile q (0..1), reported as the midpoint of its bucket
+    unsigned long long percentile(double q) const {
+        unsigned long long n = count();
+        if (n == 0) return 0;
+        unsigned long long rank = (unsigned long long)(q * (n - 1)) + 1, seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i].load(memory_order_relaxed);
+            if (seen >= rank) {
+                unsigned long long low = bucketLow(i), high = i + 1 < BUCKETS ? bucketLow(i + 1) : low;
+                return min(maxValue(), low + (high - low) / 2);
+            }
+        }
+        return maxValue();
+    }
+};
+
+// Process-wide counters behind the "System Statistics" menu entries. Recording is a few relaxed
+// atomic updates; nothing is aggregated until someone asks for the numbers.
+class SystemStats {
+public:
+    struct FileCounters {
+        atomic<unsigned long long> loads{ 0 };
+        atomic<unsigned long long> bytesRead{ 0 };
+        atomic<unsigned long long> appends{ 0 };
+        atomic<unsigned long long> rewrites{ 0 };
+        atomic<unsigned long long> bytesWritten{ 0 };
+    };
+
+    atomic<unsigned long long> roomChecks{ 0 };
+    atomic<unsigned long long> roomCheckEntriesScanned{ 0 };
+    atomic<unsigned long long> idLookups{ 0 };
+    atomic<unsigned long long> scheduleQueries{ 0 };
+    atomic<unsigned long long> scheduleQueryEntriesVisited{ 0 };
+    atomic<unsigned long long> reportCacheHits{ 0 };
+    atomic<unsigned long long> reportCacheMisses{ 0 };
+    atomic<unsigned long long> reportBlocksRebuilt{ 0 };
+    atomic<unsigned long long> historyPageHits{ 0 };
+    atomic<unsigned long long> historyPageMisses{ 0 };
+    atomic<unsigned long long> historyPrefetches{ 0 };
+    atomic<unsigned long long> historyPageEvictions{ 0 };
+
+    static SystemStats& instance() {
+        static SystemStats stats;
+        return stats;
+    }
+
+    // histograms and file counters are created on first use and never move afterwards
+    LatencyHistogram& operation(const string& name) {
+        lock_guard<mutex> guard(registryLock);
+        auto& slot = operations[name];
+        if (!slot) slot.reset(new LatencyHistogram());
+        return *slot;
+    }
+
+    FileCounters& file(const string& filename) {
+        lock_guard<mutex> guard(registryLock);
+        auto& slot = files[filename];
+        if (!slot) slot.reset(new FileCounters());
+        return *slot;
+    }
+
+    void print(ostream& os) {
+        lock_guard<mutex> guard(registryLock);
+        os << left << setw(34) << "Operation" << right << setw(10) << "Count" << setw(12) << "Mean (ms)"
+            << setw(12) << "p50 (ms)" << setw(12) << "p99 (ms)" << setw(12) << "Max (ms)" << endl;
+        os << string(92, '-') << endl;
+        for (const auto& op : operations) {
+            const LatencyHistogram& h = *op.second;
+            os << left << setw(34) << op.first << right << setw(10) << h.count() << fixed << setprecision(3)
+                << setw(12) << h.mean() / 1e6 << setw(12) << h.percentile(0.50) / 1e6
+                << setw(12) << h.percentile(0.99) / 1e6 << setw(12) << h.maxValue() / 1e6 << endl;
+        }
+
+        os << "\n" << left << setw(24) << "File" << right << setw(8) << "Loads" << setw(14) << "Bytes Read"
+            << setw(10) << "Appends" << setw(10) << "Rewrites" << setw(16) << "Bytes Written" << endl;
+        os << string(82, '-') << endl;
+        for (const auto& f : files) {
+            const FileCounters& c = *f.second;
+            os << left << setw(24) << f.first << right << setw(8) << c.loads << setw(14) << c.bytesRead
+                << setw(10) << c.appends << setw(10) << c.rewrites << setw(16) << c.bytesWritten << endl;
+        }
+
+        os << "\nRoom availability checks: " << roomChecks << " (" << roomCheckEntriesScanned << " entries scanned)\n";
+        os << "ID lookups: " << idLookups << endl;
+        os << "Schedule queries: " << scheduleQueries << " (" << scheduleQueryEntriesVisited << " entries visited)\n";
+        os << "Report cache: " << reportCacheHits << " hits, " << reportCacheMisses << " misses, "
+            << reportBlocksRebuilt << " section blocks rebuilt\n";
+        os << "History page cache: " << historyPageHits << " hits, " << historyPageMisses << " misses, "
+            << historyPrefetches << " prefetched, " << historyPageEvictions << " evicted\n";
+    }
+
+    // JSON snapshot for scripts and dashboards
+    bool dump(const string& path) {
+        ofstream ofs(path);
+        if (!ofs) return false;
+        lock_guard<mutex> guard(registryLock);
+        ofs << "{\n  \"operations\": {";
+        bool first = true;
+        for (const auto& op : operations) {
+            const LatencyHistogram& h = *op.second;
+            ofs << (first ? "\n" : ",\n") << "    \"" << op.first << "\": {\"count\": " << h.count()
+                << ", \"mean_ns\": " << (unsigned long long)h.mean() << ", \"p50_ns\": " << h.percentile(0.50)
+                << ", \"p90_ns\": " << h.percentile(0.90) << ", \"p99_ns\": " << h.percentile(0.99)
+                << ", \"max_ns\": " << h.maxValue() << "}";
+            first = false;
+        }
+        ofs << "\n  },\n  \"files\": {";
+        first = true;
+        for (const auto& f : files) {
+            const FileCounters& c = *f.second;
+            ofs << (first ? "\n" : ",\n") << "    \"" << f.first << "\": {\"loads\": " << c.loads
+                << ", \"bytes_read\": " << c.bytesRead << ", \"appends\": " << c.appends
+                << ", \"rewrites\": " << c.rewrites << ", \"bytes_written\": " << c.bytesWritten << "}";
+            first = false;
+        }
+        ofs << "\n  },\n  \"room_checks\": " << roomChecks << ",\n  \"room_check_entries_scanned\": " << roomCheckEntriesScanned
+            << ",\n  \"id_lookups\": " << idLookups << ",\n  \"schedule_queries\": " << scheduleQueries
+            << ",\n  \"schedule_query_entries_visited\": " << scheduleQueryEntriesVisited
+            << ",\n  \"report_cache_hits\": " << reportCacheHits << ",\n  \"report_cache_misses\": " << reportCacheMisses
+            << ",\n  \"report_blocks_rebuilt\": " << reportBlocksRebuilt
+            << ",\n  \"history_page_hits\": " << historyPageHits
+            << ",\n  \"history_page_misses\": " << historyPageMisses << ",\n  \"history_prefetches\": " << historyPrefetches
+            << ",\n  \"history_page_evictions\": " << historyPageEvictions << "\n}\n";
+        return true;
+    }
+
+private:
+    mutex registryLock;
+    map<string, unique_ptr<LatencyHistogram>> operations;
+    map<string, unique_ptr<FileCounters>> files;
+};
+
+// records the lifetime of a scope into a histogram
+class ScopedTimer {
+private:
+    LatencyHistogram& histogram;
+    chrono::steady_clock::time_point begin;
+
+public:
+    ScopedTimer(LatencyHistogram& h) : histogram(h), begin(chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram.record((unsigned long long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count());
+    }
+};
+
+// Chrome/Perfetto trace recording, enabled by LMS_TRACE=<file> or --trace <file>.
+// Each thread appends finished spans to its own fixed-size ring (oldest spans are overwritten),
+// so recording takes no locks; the rings are exported once, after the work has finished.
+struct TraceEvent {
+    char name[56];
+    long long startNs;
+    long long durationNs;
+};
+
+class TraceRing {
+public:
+    static const size_t CAPACITY = 1 << 16;
+    vector<TraceEvent> events;
+    atomic<size_t> head{ 0 };
+    int threadId;
+
+    TraceRing(int tid) : events(CAPACITY), threadId(tid) {}
+
+    // single producer: only the owning thread calls push
+    void push(const TraceEvent& e) {
+        size_t h = head.load(memory_order_relaxed);
+        events[h & (CAPACITY - 1)] = e;
+        head.store(h + 1, memory_order_release);
+    }
+};
+
+class Tracer {
+private:
+    atomic<bool> on{ false };
+    chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    mutex registryLock;
+    vector<unique_ptr<TraceRing>> rings;
+
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    bool enabled() const { return on.load(memory_order_relaxed); }
+    void enable() { on.store(true, memory_order_relaxed); }
+
+    long long nowNs() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+    }
+
+    // the calling thread's ring, registered on first use
+    TraceRing& ring() {
+        thread_local TraceRing* mine = nullptr;
+        if (!mine) {
+            lock_guard<mutex> guard(registryLock);
+            rings.emplace_back(new TraceRing((int)rings.size() + 1));
+            mine = rings.back().get();
+        }
+        return *mine;
+    }
+
+    bool exportTo(const string& path) {
+        ofstream ofs(path);
+        if (!ofs) return false;
+        lock_guard<mutex> guard(registryLock);
+        ofs << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& r : rings) {
+            size_t head = r->head.load(memory_order_acquire);
+            size_t begin = head > TraceRing::CAPACITY ? head - TraceRing::CAPACITY : 0;
+            for (size_t i = begin; i < head; ++i) {
+                const TraceEvent& e = r->events[i & (TraceRing::CAPACITY - 1)];
+                ofs << (first ? "" : ",\n") << "{\"name\":\"" << e.name << "\",\"cat\":\"lms\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                    << r->threadId << fixed << setprecision(3) << ",\"ts\":" << e.startNs / 1000.0
+                    << ",\"dur\":" << e.durationNs / 1000.0 << "}";
+                first = false;
+            }
+        }
+        ofs << "\n]}\n";
+        return true;
+    }
+};
+
+// Records one complete ("X") event for its scope when tracing is on; otherwise a single branch.
+// The optional detail (e.g. a file name) is appended to the span name.
+class TraceSpan {
+private:
+    const char* name;
+    const char* detail;
+    long long start = -1;
+
+public:
+    TraceSpan(const char* n, const char* d = nullptr) : name(n), detail(d) {
+        if (Tracer::instance().enabled()) start = Tracer::instance().nowNs();
+    }
+
+    ~TraceSpan() { end(); }
+
+    // closes the span before the end of its scope (e.g. one phase of a longer function)
+    void end() {
+        if (start < 0) return;
+        Tracer& tracer = Tracer::instance();
+        TraceEvent e;
+        snprintf(e.name, sizeof(e.name), detail ? "%s %s" : "%s", name, detail);
+        e.startNs = start;
+        e.durationNs = tracer.nowNs() - start;
+        tracer.ring().push(e);
+        start = -1;
+    }
+};
+
+// Turns tracing on for the lifetime of main and writes the trace file on the way out.
+class TraceSession {
+private:
+    string path;
+
+public:
+    TraceSession(const string& file) : path(file) {
+        if (!path.empty()) Tracer::instance().enable();
+    }
+    ~TraceSession() {
+        if (path.empty()) return;
+        if (Tracer::instance().exportTo(path)) cerr << "Trace written to " << path << endl;
+        else cerr << "[ERROR] Could not write trace file " << path << endl;
+    }
+};
+
+// Append-only record storage in fixed-size chunks. Elements never move once inserted, so the
+// pointers DataManager hands out (logged-in user, room lists, pending requests) stay valid while
+// records are added. The chunk directory is allocated up front and the size is published with
+// release ordering, so readers on other threads may iterate up to size() while one writer appends.
+// clear() releases all chunks at once; eraseIf() is the only call that moves elements.
+template <typename T, size_t CHUNK_BITS = 10>
+class SlabStore {
+private:
+    static constexpr size_t CHUNK = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = 16384; // 16M records at the default chunk size
+
+    unique_ptr<atomic<T*>[]> chunks;
+    atomic<size_t> count;
+
+    T* slot(size_t i) const { return chunks[i >> CHUNK_BITS].load(memory_order_acquire) + (i & (CHUNK - 1)); }
+
+public:
+    template <typename Ptr, typename Ref>
+    class Iterator {
+    private:
+        const SlabStore* store;
+        size_t i;
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef Ptr pointer;
+        typedef Ref reference;
+
+        Iterator(const SlabStore* s = nullptr, size_t index = 0) : store(s), i(index) {}
+        Ref operator*() const { return *store->slot(i); }
+        Ptr operator->() const { return store->slot(i); }
+        Iterator& operator++() { ++i; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++i; return old; }
+        bool operator==(const Iterator& other) const { return i == other.i; }
+        bool operator!=(const Iterator& other) const { return i != other.i; }
+    };
+    typedef T value_type;
+    typedef Iterator<T*, T&> iterator;
+    typedef Iterator<const T*, const T&> const_iterator;
+
+    SlabStore() : chunks(new atomic<T*>[MAX_CHUNKS]), count(0) {
+        for (size_t c = 0; c < MAX_CHUNKS; ++c) chunks[c].store(nullptr, memory_order_relaxed);
+    }
+    SlabStore(const SlabStore&) = delete;
+    SlabStore& operator=(const SlabStore&) = delete;
+    ~SlabStore() { clear(); }
+
+    // single writer
+    T& push_back(const T& value) {
+        size_t n = count.load(memory_order_relaxed);
+        size_t c = n >> CHUNK_BITS;
+        if (c >= MAX_CHUNKS) {
+            cerr << "[ERROR] Record store is full (" << n << " records)." << endl;
+            abort();
+        }
+        T* chunk = chunks[c].load(memory_order_relaxed);
+        if (!chunk) {
+            chunk = static_cast<T*>(::operator new(sizeof(T) * CHUNK));
+            chunks[c].store(chunk, memory_order_release);
+        }
+        T* item = new (chunk + (n & (CHUNK - 1))) T(value);
+        count.store(n + 1, memory_order_release);
+        return *item;
+    }
+
+    void clear() {
+        size_t n = count.load(memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) slot(i)->~T();
+        for (size_t c = 0; c < MAX_CHUNKS && chunks[c].load(memory_order_relaxed); ++c) {
+            ::operator delete(chunks[c].load(memory_order_relaxed));
+            chunks[c].store(nullptr, memory_order_relaxed);
+        }
+        count.store(0, memory_order_release);
+    }
+
+    // Removes the elements for which pred(index) is true, compacting in place and in order.
+    // Elements before the first removed one stay where they are; later survivors move down into
+    // the freed slots, so pointers to them become invalid. Chunks left empty are released.
+    // Single writer, with no concurrent readers. Returns the number removed.
+    template <typename Pred>
+    size_t eraseIf(Pred pred) {
+        size_t n = count.load(memory_order_relaxed);
+        size_t kept = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (pred(i)) continue;
+            if (kept != i) *slot(kept) = std::move(*slot(i));
+            ++kept;
+        }
+        for (size_t i = kept; i < n; ++i) slot(i)->~T();
+        for (size_t c = (kept + CHUNK - 1) >> CHUNK_BITS; c < MAX_CHUNKS && chunks[c].load(memory_order_relaxed); ++c) {
+            ::operator delete(chunks[c].load(memory_order_relaxed));
+            chunks[c].store(nullptr, memory_order_relaxed);
+        }
+        count.store(kept, memory_order_release);
+        return n - kept;
+    }
+
+    size_t size() const { return count.load(memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    T& operator[](size_t i) { return *slot(i); }
+    const T& operator[](size_t i) const { return *slot(i); }
+    T& front() { return *slot(0); }
+    const T& front() const { return *slot(0); }
+    T& back() { return *slot(size() - 1); }
+    const T& back() const { return *slot(size() - 1); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
+
+// Interns names, codes and passwords. Each distinct string is stored once in append-only arena
+// chunks and records keep a 4-byte handle, so equal handles mean equal strings. Handle 0 is "".
+class StringPool {
+private:
+    static constexpr size_t ARENA_CHUNK = 64 * 1024;
+    vector<unique_ptr<char[]>> arenas;
+    size_t arenaSize = 0, arenaUsed = 0;
+    SlabStore<string_view> views; // handle -> text, readable without the lock
+    unordered_map<string_view, uint32_t> lookup;
+    size_t bytes = 0;
+    mutable mutex lock;
+
+    StringPool() {
+        views.push_back(string_view());
+        lookup[string_view()] = 0;
+    }
+
+public:
+    static StringPool& instance() {
+        static StringPool pool;
+        return pool;
+    }
+
+    uint32_t intern(string_view s) {
+        lock_guard<mutex> guard(lock);
+        auto it = lookup.find(s);
+        if (it != lookup.end()) return it->second;
+        if (s.size() > arenaSize - arenaUsed) {
+            arenaSize = max(ARENA_CHUNK, s.size());
+            arenas.emplace_back(new char[arenaSize]);
+            arenaUsed = 0;
+        }
+        char* text = arenas.back().get() + arenaUsed;
+        memcpy(text, s.data(), s.size());
+        arenaUsed += s.size();
+        bytes += s.size();
+        uint32_t id = (uint32_t)views.size();
+        views.push_back(string_view(text, s.size()));
+        lookup[views.back()] = id;
+        return id;
+    }
+
+    string_view view(uint32_t id) const { return views[id]; }
+    size_t count() const { return views.size(); }
+    size_t byteCount() const { lock_guard<mutex> guard(lock); return bytes; }
+};
+
+// Handle to an interned string; compares by handle, prints and converts like a string.
+class IString {
+private:
+    uint32_t id = 0;
+
+public:
+    IString() {}
+    IString(const string& s) : id(StringPool::instance().intern(s)) {}
+    IString(const char* s) : id(StringPool::instance().intern(s)) {}
+    explicit IString(string_view s) : id(StringPool::instance().intern(s)) {}
+
+    string_view view() const { return StringPool::instance().view(id); }
+    string str() const { return string(view()); }
+    operator string() const { return str(); }
+    uint32_t handle() const { return id; }
+    bool empty() const { return id == 0; }
+    size_t size() const { return view().size(); }
+
+    bool operator==(const IString& other) const { return id == other.id; }
+    bool operator!=(const IString& other) const { return id != other.id; }
+    bool operator==(const string& other) const { return view() == other; }
+    bool operator!=(const string& other) const { return view() != other; }
+    friend bool operator==(const string& a, const IString& b) { return b == a; }
+    friend bool operator!=(const string& a, const IString& b) { return b != a; }
+    friend string operator+(const string& a, const IString& b) { return a + b.str(); }
+    friend string operator+(const IString& a, const string& b) { return a.str() + b; }
+    friend ostream& operator<<(ostream& os, const IString& s) { return os << s.view(); }
+};
+
+// Vector of at most N trivially copyable elements stored inline with a one-byte count, for short
+// bounded id lists (a section's TAs, the people a section charges); never touches the heap.
+template <typename T, size_t N>
+class SmallVector {
+private:
+    T items[N] = {};
+    uint8_t count = 0;
+
+public:
+    typedef T value_type;
+    static_assert(N < 256, "count is stored in one byte");
+
+    // false (and nothing added) when full
+    bool push_back(const T& value) {
+        if (count == N) return false;
+        items[count++] = value;
+        return true;
+    }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    static size_t capacity() { return N; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+};
+
+// binary records
+
+// Output buffer for .dat files; records are encoded into it and written with one call.
+class ByteWriter {
+public:
+    string bytes;
+
+    // n bytes at the end of the buffer for the caller to fill
+    char* grow(size_t n) {
+        size_t at = bytes.size();
+        bytes.resize(at + n);
+        return &bytes[at];
+    }
+    void put(const void* data, size_t n) { bytes.append(static_cast<const char*>(data), n); }
+};
+
+// Cursor over a file read into memory. A short read sets failed and leaves the cursor at the end.
+class ByteReader {
+public:
+    const char* pos;
+    const char* end;
+    bool failed = false;
+
+    ByteReader(const char* begin, const char* finish) : pos(begin), end(finish) {}
+
+    bool atEnd() const { return pos >= end; }
+    size_t remaining() const { return (size_t)(end - pos); }
+    // the next n bytes, or nullptr when fewer are left
+    const char* take(size_t n) {
+        if (remaining() < n) { failed = true; pos = end; return nullptr; }
+        const char* at = pos;
+        pos += n;
+        return at;
+    }
+    template <typename T>
+    bool get(T& value) {
+        const char* p = take(sizeof(T));
+        if (p) memcpy(&value, p, sizeof(T));
+        return p != nullptr;
+    }
+    bool getVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (atEnd()) { failed = true; return false; }
+            unsigned char b = (unsigned char)*pos++;
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        failed = true;
+        return false;
+    }
+};
+
+// LEB128 varints, with zigzag for signed deltas, for the compact archive encoding
+inline void putVarint(ByteWriter& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.bytes.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.bytes.push_back((char)value);
+}
+inline uint64_t zigzag(long long v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline long long unzigzag(uint64_t v) { return (long long)(v >> 1) ^ -(long long)(v & 1); }
+
+// How one member type is stored. Trivially copyable types are stored as their in-memory bytes
+// (fixedSize > 0); strings and id lists carry a length and go through write/read.
+template <typename M>
+struct FieldCodec {
+    static_assert(is_trivially_copyable<M>::value, "no FieldCodec for this member type");
+    static constexpr char tag = 'r';
+    static constexpr size_t fixedSize = sizeof(M);
+    static void encode(char* out, const M& v) { memcpy(out, &v, sizeof(M)); }
+    static void decode(const char* in, M& v) { memcpy(&v, in, sizeof(M)); }
+    static void write(ByteWriter& out, const M& v) { encode(out.grow(sizeof(M)), v); }
+    static bool read(ByteReader& in, M& v) { return in.get(v); }
+};
+
+// size_t length, then the characters
+template <>
+struct FieldCodec<string> {
+    static constexpr char tag = 's';
+    static constexpr size_t fixedSize = 0;
+    static void write(ByteWriter& out, const string& v) {
+        size_t len = v.size();
+        out.put(&len, sizeof(size_t));
+        out.put(v.data(), len);
+    }
+    static bool read(ByteReader& in, string& v) {
+        size_t len = 0;
+        if (!in.get(len)) return false;
+        const char* p = in.take(len);
+        if (p) v.assign(p, len);
+        return p != nullptr;
+    }
+};
+
+// same bytes as string; the text is interned on read
+template <>
+struct FieldCodec<IString> {
+    static constexpr char tag = 's';
+    static constexpr size_t fixedSize = 0;
+    static void write(ByteWriter& out, const IString& v) {
+        string_view text = v.view();
+        size_t len = text.size();
+        out.put(&len, sizeof(size_t));
+        out.put(text.data(), len);
+    }
+    static bool read(ByteReader& in, IString& v) {
+        size_t len = 0;
+        if (!in.get(len)) return false;
+        const char* p = in.take(len);
+        if (p) v = IString(string_view(p, len));
+        return p != nullptr;
+    }
+};
+
+// one-byte count, then the elements
+template <typename T, size_t N>
+struct FieldCodec<SmallVector<T, N>> {
+    static constexpr char tag = 'l';
+    static constexpr size_t fixedSize = 0;
+    static void write(ByteWriter& out, const SmallVector<T, N>& v) {
+        out.bytes.push_back((char)v.size());
+        if (!v.empty()) out.put(v.begin(), v.size() * sizeof(T));
+    }
+    static bool read(ByteReader& in, SmallVector<T, N>& v) {
+        unsigned char n = 0;
+        if (!in.get(n)) return false;
+        v.clear();
+        for (unsigned char i = 0; i < n; ++i) {
+            T item;
+            if (!in.get(item)) return false;
+            v.push_back(item);
+        }
+        return true;
+    }
+};
+
+// one stored member, named by its member pointer
+template <auto Member>
+struct Field;
+template <typename C, typename M, M C::*Member>
+struct Field<Member> {
+    typedef FieldCodec<M> Codec;
+    static constexpr size_t fixedSize = Codec::fixedSize;
+    static const M& of(const C& record) { return record.*Member; }
+    static M& of(C& record) { return record.*Member; }
+};
+
+// A record layout: its fields in file order. write/read are generated from the list, so the
+// writer and reader of a type cannot drift apart. When every field is fixed-width the record is
+// packed into one wireSize block: one bounds check and straight-line copies at constant offsets.
+// layout() fingerprints the field list; each RecordSchema pins it next to its format version.
+template <typename C, typename... Fields>
+struct Schema {
+    static constexpr bool fixed = ((Fields::fixedSize > 0) && ...);
+    static constexpr size_t wireSize = (Fields::fixedSize + ... + 0);
+
+    static constexpr uint32_t layout() {
+        uint32_t h = 2166136261u;
+        ((h = (h ^ (uint32_t)Fields::Codec::tag) * 16777619u, h = (h ^ (uint32_t)Fields::fixedSize) * 16777619u), ...);
+        return h;
+    }
+
+    static void write(ByteWriter& out, const C& record) {
+        if constexpr (fixed) {
+            char* p = out.grow(wireSize);
+            ((Fields::Codec::encode(p, Fields::of(record)), p += Fields::fixedSize), ...);
+        }
+        else {
+            (Fields::Codec::write(out, Fields::of(record)), ...);
+        }
+    }
+    static bool read(ByteReader& in, C& record) {
+        if constexpr (fixed) {
+            const char* p = in.take(wireSize);
+            if (!p) return false;
+            ((Fields::Codec::decode(p, Fields::of(record)), p += Fields::fixedSize), ...);
+            return true;
+        }
+        else {
+            return (Fields::Codec::read(in, Fields::of(record)) && ...);
+        }
+    }
+};
+
+// specialized per stored type next to the type, with FORMAT (the file format version) and LAYOUT
+template <typename T>
+struct RecordSchema;
+
 class Time {
 private:
     int hour;
@@ -32,6 +807,15 @@ public:
     bool operator>(const Time& other) const { return hour != other.hour ? hour > other.hour : minute > other.minute; }
     bool operator<(const Time& other) const { return hour != other.hour ? hour < other.hour : minute < other.minute; }
     bool operator==(const Time& other) const { return hour == other.hour && minute == other.minute; }
+    // parses "HH:MM"
+    static bool parse(const string& s, Time& t) {
+        int h, m;
+        char sep;
+        stringstream ss(s);
+        if (!(ss >> h >> sep >> m) || sep != ':' || h < 0 || h > 23 || m < 0 || m > 59) return false;
+        t = Time(h, m);
+        return true;
+    }
     double calculateDurationHours(const Time& endTime) const {
         int startMinutes = hour * 60 + minute;
         int endMinutes = endTime.hour * 60 + endTime.minute;
@@ -74,6 +858,54 @@ public:
         return day < other.day;
     }
     bool operator==(const Date& other) const { return day == other.day && month == other.month && year == other.year; }
+
+    // sortable YYYYMMDD key, used by the date index
+    int toKey() const { return year * 10000 + month * 100 + day; }
+    static Date fromKey(int key) {
+        int d = key % 100, m = key / 100 % 100, y = key / 10000;
+        return Date(d, m, y, weekdayOf(d, m, y));
+    }
+
+    // parses "DD/MM/YYYY" and fills in the weekday
+    static bool parse(const string& s, Date& d) {
+        int day, month, year;
+        char a, b;
+        stringstream ss(s);
+        if (!(ss >> day >> a >> month >> b >> year) || a != '/' || b != '/') return false;
+        if (day < 1 || day > 31 || month < 1 || month > 12 || year < 2024) return false;
+        d = Date(day, month, year, weekdayOf(day, month, year));
+        return true;
+    }
+
+    // days since 01/01/1970, and back (civil calendar conversions)
+    int toDayNumber() const {
+        int y = year - (month <= 2 ? 1 : 0);
+        int era = (y >= 0 ? y : y - 399) / 400;
+        int yoe = y - era * 400;
+        int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+    static Date fromDayNumber(int z) {
+        z += 719468;
+        int era = (z >= 0 ? z : z - 146096) / 146097;
+        int doe = z - era * 146097;
+        int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int mp = (5 * doy + 2) / 153;
+        int d = doy - (153 * mp + 2) / 5 + 1;
+        int m = mp < 10 ? mp + 3 : mp - 9;
+        int y = yoe + era * 400 + (m <= 2 ? 1 : 0);
+        return Date(d, m, y, weekdayOf(d, m, y));
+    }
+    Date addDays(int n) const { return fromDayNumber(toDayNumber() + n); }
+
+    // weekday for a calendar date (0=Sunday), Sakamoto's method
+    static int weekdayOf(int d, int m, int y) {
+        static const int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+        if (m < 3) y -= 1;
+        return (y + y / 4 - y / 100 + y / 400 + t[m - 1] + d) % 7;
+    }
 };
 
 // venue
@@ -81,7 +913,7 @@ public:
 class Building {
 public:
     int buildingId;
-    string name;
+    IString name;
     string address;
     int attendantId; // 1 attendant per building
 
@@ -96,7 +928,7 @@ public:
 class Room {
 public:
     int roomId;
-    string roomName;
+    IString roomName;
     int buildingId; // References the Building class ID
 
     Room(int id = 0, const string& rName = "", int bId = 0)
@@ -109,14 +941,38 @@ public:
 
 // users
 
+// account roles; stored as one byte in persons.dat
+enum class Role : uint8_t { None = 0, AcademicOfficer, Instructor, TA, HoD, Attendant };
+
+inline const char* roleName(Role r) {
+    switch (r) {
+    case Role::AcademicOfficer: return "AcademicOfficer";
+    case Role::Instructor: return "Instructor";
+    case Role::TA: return "TA";
+    case Role::HoD: return "HoD";
+    case Role::Attendant: return "Attendant";
+    default: return "None";
+    }
+}
+
+// Role::None for anything that is not one of the five role names
+inline Role parseRole(const string& s) {
+    for (Role r : { Role::AcademicOfficer, Role::Instructor, Role::TA, Role::HoD, Role::Attendant }) {
+        if (s == roleName(r)) return r;
+    }
+    return Role::None;
+}
+
+inline ostream& operator<<(ostream& os, Role r) { return os << roleName(r); }
+
 class Person {
 public:
     int personId;
-    string name;
-    string role; 
-    string password;
+    IString name;
+    Role role; 
+    IString password;
 
-    Person(int id = 0, const string& n = "", const string& r = "", const string& p = "pass")
+    Person(int id = 0, const string& n = "", Role r = Role::None, const string& p = "pass")
         : personId(id), name(n), role(r), password(p) {
     }
 
@@ -127,38 +983,38 @@ public:
     virtual ~Person() {}
 
     string getName() const { return name; }
-    string getRole() const { return role; }
+    Role getRole() const { return role; }
 };
 
 
 class AcademicOfficer : public Person {
 public:
     AcademicOfficer(int id = 0, const std::string& n = "", const string& p = "pass")
-        : Person(id, n, "AcademicOfficer", p) {
+        : Person(id, n, Role::AcademicOfficer, p) {
     }
 };
 class Instructor : public Person {
 public:
     Instructor(int id = 0, const string& n = "", const string& p = "pass")
-        : Person(id, n, "Instructor", p) {
+        : Person(id, n, Role::Instructor, p) {
     }
 };
 class TA : public Person {
 public:
     TA(int id = 0, const string& n = "", const string& p = "pass")
-        : Person(id, n, "TA", p) {
+        : Person(id, n, Role::TA, p) {
     }
 };
 class HoD : public Person {
 public:
     HoD(long long id = 0, const std::string& n = "", const std::string& p = "pass")
-        : Person(id, n, "HoD", p) {
+        : Person(id, n, Role::HoD, p) {
     }
 };
 class Attendant : public Person {
 public:
     Attendant(int id = 0, const string& n = "", const string& p = "pass")
-        : Person(id, n, "Attendant", p) {
+        : Person(id, n, Role::Attendant, p) {
     }
 };
 
@@ -168,8 +1024,8 @@ public:
 class Course {
 public:
     int courseId;
-    string courseCode;
-    string courseName; 
+    IString courseCode;
+    IString courseName; 
 
     Course(long long id = 0, const string& cCode = "", const string& cName = "")
         : courseId(id), courseCode(cCode), courseName(cName) {
@@ -180,26 +1036,26 @@ public:
     string getCourseName() const { return courseName; }
 };
 
-class LabSection : public Course {
+// a section refers to its course by id; code and name live once in the course table
+class LabSection {
 public:
+    int courseId;
     int sectionId;
-    string sectionName; 
+    IString sectionName; 
+    static const size_t MAX_TAS = 5;
     int instructorId;
-    vector<int> taIds; 
+    SmallVector<int, MAX_TAS> taIds; 
 
-    LabSection(int cId = 0, const string& cCode = "", const string& cName = "",
-        int sId = 0, const string& sName = "", long long insId = 0)
-        : Course(cId, cCode, cName),
-        sectionId(sId), sectionName(sName), instructorId(insId) {
+    LabSection(int cId = 0, int sId = 0, const string& sName = "", long long insId = 0)
+        : courseId(cId), sectionId(sId), sectionName(sName), instructorId(insId) {
     }
 
-    void addTA(int taId) {
-        if (taIds.size() < 5) { 
-            taIds.push_back(taId);
-        }
+    // false if the TA is already listed or the list is full
+    bool addTA(int taId) {
+        if (find(taIds.begin(), taIds.end(), taId) != taIds.end()) return false;
+        return taIds.push_back(taId);
     }
 
-    string getFullSectionCode() const { return courseCode + "-" + sectionName; }
     int getInstructorId() const { return instructorId; }
 };
 
@@ -231,18 +1087,148 @@ public:
     }
 };
 
+// Schedules stored column by column. The fields every scan reads (section, room, date key,
+// expected times in minutes, state) sit in dense columns of their own; actual times, the makeup
+// flag and the full date live in a cold column. Indexing and iteration assemble ScheduleEntry
+// values, so menu and report code can keep working with whole entries.
+class ScheduleStore {
+private:
+    static const uint8_t CANCELED = 0x80; // state: status in the low bits, this bit when canceled
+
+    struct Cold {
+        int scheduleId;
+        Date scheduledDate;
+        Time actualStart;
+        Time actualEnd;
+        bool isMakeup;
+    };
+
+    SlabStore<int, 12> sectionIds;
+    SlabStore<int, 12> roomIds;
+    SlabStore<int, 12> dateKeys;
+    SlabStore<uint16_t, 12> starts; // minutes since midnight
+    SlabStore<uint16_t, 12> ends;
+    SlabStore<uint8_t, 12> states;
+    SlabStore<Cold, 12> cold;
+
+    static uint16_t minutesOf(const Time& t) { return (uint16_t)(t.getHour() * 60 + t.getMinute()); }
+
+public:
+    typedef ScheduleEntry value_type;
+
+    class const_iterator {
+    private:
+        const ScheduleStore* store;
+        size_t i;
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef ScheduleEntry value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const ScheduleEntry* pointer;
+        typedef ScheduleEntry reference;
+
+        const_iterator(const ScheduleStore* s = nullptr, size_t index = 0) : store(s), i(index) {}
+        ScheduleEntry operator*() const { return (*store)[i]; }
+        const_iterator& operator++() { ++i; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++i; return old; }
+        bool operator==(const const_iterator& other) const { return i == other.i; }
+        bool operator!=(const const_iterator& other) const { return i != other.i; }
+    };
+
+    void push_back(const ScheduleEntry& se) {
+        cold.push_back(Cold{ se.scheduleId, se.scheduledDate, se.actualStart, se.actualEnd, se.isMakeup });
+        sectionIds.push_back(se.sectionId);
+        roomIds.push_back(se.roomId);
+        dateKeys.push_back(se.scheduledDate.toKey());
+        starts.push_back(minutesOf(se.expectedStart));
+        ends.push_back(minutesOf(se.expectedEnd));
+        states.push_back((uint8_t)((se.status & 0x7f) | (se.isCanceled ? CANCELED : 0)));
+    }
+
+    void clear() {
+        sectionIds.clear(); roomIds.clear(); dateKeys.clear();
+        starts.clear(); ends.clear(); states.clear(); cold.clear();
+    }
+
+    // drops the rows for which pred(position) is true from every column, keeping the rest in
+    // order; positions after the first dropped row shift down (see SlabStore::eraseIf)
+    template <typename Pred>
+    size_t eraseIf(Pred pred) {
+        vector<bool> drop(size());
+        for (size_t i = 0; i < drop.size(); ++i) drop[i] = pred(i);
+        auto dropped = [&drop](size_t i) { return (bool)drop[i]; };
+        sectionIds.eraseIf(dropped); roomIds.eraseIf(dropped); dateKeys.eraseIf(dropped);
+        starts.eraseIf(dropped); ends.eraseIf(dropped); cold.eraseIf(dropped);
+        return states.eraseIf(dropped);
+    }
+
+    // the state column is written last, so its size is the number of complete rows
+    size_t size() const { return states.size(); }
+    bool empty() const { return size() == 0; }
+
+    // hot columns
+    int sectionId(size_t i) const { return sectionIds[i]; }
+    int roomId(size_t i) const { return roomIds[i]; }
+    int dateKey(size_t i) const { return dateKeys[i]; }
+    int startMinute(size_t i) const { return starts[i]; }
+    int endMinute(size_t i) const { return ends[i]; }
+    int status(size_t i) const { return states[i] & 0x7f; }
+    bool isCanceled(size_t i) const { return (states[i] & CANCELED) != 0; }
+    // expected time overlaps [startMin, endMin) and the session is not canceled
+    bool blocks(size_t i, int startMin, int endMin) const {
+        return starts[i] < endMin && startMin < ends[i] && !(states[i] & CANCELED);
+    }
+
+    // cold columns
+    int scheduleId(size_t i) const { return cold[i].scheduleId; }
+    bool isMakeup(size_t i) const { return cold[i].isMakeup; }
+    Time actualStart(size_t i) const { return cold[i].actualStart; }
+    Time actualEnd(size_t i) const { return cold[i].actualEnd; }
+
+    void setActual(size_t i, const Time& start, const Time& end) {
+        cold[i].actualStart = start;
+        cold[i].actualEnd = end;
+        states[i] = (uint8_t)((states[i] & CANCELED) | 1); // 1: Timesheet Filled
+    }
+    void setCanceled(size_t i) { states[i] = CANCELED | 2; } // 2: Canceled
+    void set(size_t i, const ScheduleEntry& se) {
+        cold[i] = Cold{ se.scheduleId, se.scheduledDate, se.actualStart, se.actualEnd, se.isMakeup };
+        sectionIds[i] = se.sectionId;
+        roomIds[i] = se.roomId;
+        dateKeys[i] = se.scheduledDate.toKey();
+        starts[i] = minutesOf(se.expectedStart);
+        ends[i] = minutesOf(se.expectedEnd);
+        states[i] = (uint8_t)((se.status & 0x7f) | (se.isCanceled ? CANCELED : 0));
+    }
+
+    ScheduleEntry operator[](size_t i) const {
+        const Cold& c = cold[i];
+        ScheduleEntry se(c.scheduleId, sectionIds[i], roomIds[i], c.scheduledDate,
+            Time(starts[i] / 60, starts[i] % 60), Time(ends[i] / 60, ends[i] % 60), c.isMakeup);
+        se.actualStart = c.actualStart;
+        se.actualEnd = c.actualEnd;
+        se.status = status(i);
+        se.isCanceled = isCanceled(i);
+        return se;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
+
 class MakeupRequest {
 public:
-    long long requestId;
-    long long sectionId;
-    long long instructorId;
+    int requestId;
+    int sectionId;
+    int instructorId;
     Date requestedDate;
     Time requestedStart;
     Time requestedEnd;
     std::string reason;
     int status; // 0: Pending, 1: Approved, 2: Disapproved
 
-    MakeupRequest(long long id = 0, long long secId = 0, long long insId = 0,
+    MakeupRequest(int id = 0, int secId = 0, int insId = 0,
         const Date& rDate = Date(), const Time& rS = Time(), const Time& rE = Time(),
         const std::string& rsn = "")
         : requestId(id), sectionId(secId), instructorId(insId), requestedDate(rDate),
@@ -251,472 +1237,2928 @@ public:
 };
 
 
-// manager classes
+// holiday / leave calendar entry
+class Holiday {
+public:
+    int holidayId;
+    Date startDate;
+    Date endDate;
+    string description;
+    int buildingId;   // 0: all buildings
+    int sectionId;    // 0: all sections
+    int instructorId; // 0: all instructors, otherwise an instructor leave
+
+    Holiday(int id = 0, const Date& from = Date(), const Date& to = Date(), const string& desc = "",
+        int bId = 0, int secId = 0, int insId = 0)
+        : holidayId(id), startDate(from), endDate(to), description(desc),
+        buildingId(bId), sectionId(secId), instructorId(insId) {
+    }
 
-class DataManager {
-private:
+    bool isCampusWide() const { return buildingId == 0 && sectionId == 0 && instructorId == 0; }
+    bool covers(const Date& d) const { return startDate.toKey() <= d.toKey() && d.toKey() <= endDate.toKey(); }
+};
 
-    static int nextPersonId;
-    static int nextLabSectionId;
-    static int nextRoomId;
-    static int nextScheduleId;
-    static int nextMakeupId;
-    static int nextBuildingId;
+// one closed semester moved to the archive tier; the list is kept in archive.dat
+class ArchivedSemester {
+public:
+    int semester;      // year * 10 + 1 (January-June) or 2 (July-December)
+    int scheduleCount;
+    int requestCount;
+    int maxScheduleId; // ids stay reserved after their records leave the active files
+    int maxRequestId;
+    int fileBytes;
+    int schedulePages; // session pages come first in the file, then the request pages
+    int requestPages;
+
+    ArchivedSemester(int sem = 0) : semester(sem), scheduleCount(0), requestCount(0), maxScheduleId(0), maxRequestId(0),
+        fileBytes(0), schedulePages(0), requestPages(0) {}
+
+    static int of(int dateKey) { return dateKey / 10000 * 10 + (dateKey / 100 % 100 <= 6 ? 1 : 2); }
+    static string name(int semester) { return to_string(semester / 10) + "S" + to_string(semester % 10); }
+    int firstKey() const { return semester / 10 * 10000 + (semester % 10 == 1 ? 101 : 701); }
+    int lastKey() const { return semester / 10 * 10000 + (semester % 10 == 1 ? 630 : 1231); }
+};
 
-    // Filepaths
-    const string PERSONS_FILE = "persons.dat";
-    const string LABS_FILE = "labs.dat";
-    const string ROOMS_FILE = "rooms.dat";
-    const string SCHEDULES_FILE = "schedules.dat";
-    const string MAKEUP_FILE = "makeup_requests.dat";
-    const string BUILDINGS_FILE = "buildings.dat";
+// storage layouts
 
+// persons.dat. 0: 8-byte id and the role spelled out, 1: int id and a one-byte role
+template <>
+struct RecordSchema<Person> : Schema<Person, Field<&Person::personId>, Field<&Person::name>,
+    Field<&Person::role>, Field<&Person::password>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0x1d53f2c6u;
+};
 
-    // to write a string to binary file
-    void writeString(std::ofstream& ofs, const std::string& s) {
-        size_t len = s.size();
-        ofs.write(reinterpret_cast<const char*>(&len), sizeof(size_t));
-        ofs.write(s.data(), len);
-    }
+// buildings.dat. 0: ids in 8-byte slots, 1: int ids
+template <>
+struct RecordSchema<Building> : Schema<Building, Field<&Building::buildingId>, Field<&Building::name>,
+    Field<&Building::address>, Field<&Building::attendantId>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0xff0593fdu;
+};
 
-    // to read a string from binary file
-    void readString(std::ifstream& ifs, std::string& s) {
-        size_t len = 0;
-        ifs.read(reinterpret_cast<char*>(&len), sizeof(size_t));
-        if (len > 0) {
-            std::vector<char> buffer(len);
-            ifs.read(buffer.data(), len);
-            s.assign(buffer.begin(), buffer.end());
-        }
-        else {
-            s.clear();
-        }
-    }
+// rooms.dat. 0: ids in 8-byte slots, 1: int ids
+template <>
+struct RecordSchema<Room> : Schema<Room, Field<&Room::roomId>, Field<&Room::roomName>, Field<&Room::buildingId>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0x4d0abfc6u;
+};
 
-    // to write a vector 
-    template <typename T>
-    void writeVector(std::ofstream& ofs, const std::vector<T>& v) {
-        size_t size = v.size();
-        ofs.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
-        if (size > 0) {
-            ofs.write(reinterpret_cast<const char*>(v.data()), size * sizeof(T));
-        }
-    }
+// courses.dat
+template <>
+struct RecordSchema<Course> : Schema<Course, Field<&Course::courseId>, Field<&Course::courseCode>, Field<&Course::courseName>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0x770d407bu;
+};
 
-    // to read a vector 
-    template <typename T>
-    void readVector(std::ifstream& ifs, std::vector<T>& v) {
-        size_t size = 0;
-        ifs.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-        v.resize(size);
-        if (size > 0) {
-            ifs.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
-        }
-    }
+// labs.dat. 0: course code and name in every section (migrated into courses.dat),
+// 1: courseId and a size_t TA count, 2: one-byte TA count
+template <>
+struct RecordSchema<LabSection> : Schema<LabSection, Field<&LabSection::courseId>, Field<&LabSection::sectionId>,
+    Field<&LabSection::sectionName>, Field<&LabSection::instructorId>, Field<&LabSection::taIds>> {
+    static const int FORMAT = 2;
+    static const uint32_t LAYOUT = 0x64c08844u;
+};
 
+// schedules.dat. 0: the in-memory struct including padding, 1: fields packed (66 bytes)
+template <>
+struct RecordSchema<ScheduleEntry> : Schema<ScheduleEntry, Field<&ScheduleEntry::scheduleId>,
+    Field<&ScheduleEntry::sectionId>, Field<&ScheduleEntry::roomId>, Field<&ScheduleEntry::scheduledDate>,
+    Field<&ScheduleEntry::expectedStart>, Field<&ScheduleEntry::expectedEnd>, Field<&ScheduleEntry::actualStart>,
+    Field<&ScheduleEntry::actualEnd>, Field<&ScheduleEntry::isMakeup>, Field<&ScheduleEntry::isCanceled>,
+    Field<&ScheduleEntry::status>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0xf96d41b3u;
+};
 
-    // Writes/Reads a single Person object 
-    void writeData(std::ofstream& ofs, const Person& p) {
-        ofs.write(reinterpret_cast<const char*>(&p.personId), sizeof(long long));
-        writeString(ofs, p.name);
-        writeString(ofs, p.role);
-        writeString(ofs, p.password);
-    }
-    void readData(std::ifstream& ifs, Person& p) {
-        ifs.read(reinterpret_cast<char*>(&p.personId), sizeof(long long));
-        readString(ifs, p.name);
-        readString(ifs, p.role);
-        readString(ifs, p.password);
+// makeup_requests.dat. 0: ids in 8-byte slots, 1: int ids
+template <>
+struct RecordSchema<MakeupRequest> : Schema<MakeupRequest, Field<&MakeupRequest::requestId>,
+    Field<&MakeupRequest::sectionId>, Field<&MakeupRequest::instructorId>, Field<&MakeupRequest::requestedDate>,
+    Field<&MakeupRequest::requestedStart>, Field<&MakeupRequest::requestedEnd>, Field<&MakeupRequest::reason>,
+    Field<&MakeupRequest::status>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0x2f8e6c64u;
+};
+
+// holidays.dat. 0: same fields without the file header
+template <>
+struct RecordSchema<Holiday> : Schema<Holiday, Field<&Holiday::holidayId>, Field<&Holiday::startDate>,
+    Field<&Holiday::endDate>, Field<&Holiday::description>, Field<&Holiday::buildingId>,
+    Field<&Holiday::sectionId>, Field<&Holiday::instructorId>> {
+    static const int FORMAT = 1;
+    static const uint32_t LAYOUT = 0x7ab8235eu;
+};
+
+// archive.dat, the archive tier's table of contents. 1: no page counts (unpaged archive files)
+template <>
+struct RecordSchema<ArchivedSemester> : Schema<ArchivedSemester, Field<&ArchivedSemester::semester>,
+    Field<&ArchivedSemester::scheduleCount>, Field<&ArchivedSemester::requestCount>,
+    Field<&ArchivedSemester::maxScheduleId>, Field<&ArchivedSemester::maxRequestId>, Field<&ArchivedSemester::fileBytes>,
+    Field<&ArchivedSemester::schedulePages>, Field<&ArchivedSemester::requestPages>> {
+    static const int FORMAT = 2;
+    static const uint32_t LAYOUT = 0x03f57f45u;
+};
+
+
+// Room occupancy per day at 5-minute resolution: 288 slots in five 64-bit words per room.
+// Rooms are addressed by their position in DataManager::rooms and the words are stored plane
+// by plane (word w of every room is contiguous), so a free-room search is one AND/OR sweep
+// across all rooms that runs 2 or 4 rooms per instruction with SSE2/AVX2.
+// A session marks every slot it touches, so "no marked slot" always means free; sessions or
+// queries that do not start and end on a slot boundary are flagged for an exact check.
+class OccupancyIndex {
+public:
+    static const int SLOT_MINUTES = 5;
+    static const int WORDS = 5;
+
+    enum SlotState : uint8_t { BUSY = 0, FREE = 1, CHECK = 2 };
+
+private:
+    struct DayPlanes {
+        vector<uint64_t> planes[WORDS];
+        vector<uint8_t> inexact; // room has a session not aligned to slot boundaries
+
+        void ensure(size_t rooms) {
+            if (inexact.size() >= rooms) return;
+            for (auto& p : planes) p.resize(rooms, 0);
+            inexact.resize(rooms, 0);
+        }
+    };
+
+    unordered_map<int, DayPlanes> days;
+    size_t roomCount = 0;
+
+public:
+    static bool isAligned(const Time& start, const Time& end) {
+        return start < end && start.getMinute() % SLOT_MINUTES == 0 && end.getMinute() % SLOT_MINUTES == 0;
     }
 
-    // Writes/Reads a single Building object 
-    void writeData(std::ofstream& ofs, const Building& b) {
-        ofs.write(reinterpret_cast<const char*>(&b.buildingId), sizeof(long long));
-        writeString(ofs, b.name);
-        writeString(ofs, b.address);
-        ofs.write(reinterpret_cast<const char*>(&b.attendantId), sizeof(long long));
+    // slots touched by [start, end); reversed or empty ranges cover the slots between the two times
+    static void slotMask(const Time& start, const Time& end, uint64_t mask[WORDS]) {
+        int a = start.getHour() * 60 + start.getMinute();
+        int b = end.getHour() * 60 + end.getMinute();
+        if (b < a) swap(a, b);
+        int first = a / SLOT_MINUTES;
+        int last = max(first + 1, (b + SLOT_MINUTES - 1) / SLOT_MINUTES);
+        for (int w = 0; w < WORDS; ++w) mask[w] = 0;
+        for (int slot = first; slot < last; ++slot) mask[slot / 64] |= 1ULL << (slot % 64);
     }
-    void readData(std::ifstream& ifs, Building& b) {
-        ifs.read(reinterpret_cast<char*>(&b.buildingId), sizeof(long long));
-        readString(ifs, b.name);
-        readString(ifs, b.address);
-        ifs.read(reinterpret_cast<char*>(&b.attendantId), sizeof(long long));
+
+    static int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
     }
 
-    // Writes/Reads a single Room object 
-    void writeData(std::ofstream& ofs, const Room& r) {
-        ofs.write(reinterpret_cast<const char*>(&r.roomId), sizeof(long long));
-        writeString(ofs, r.roomName);
-        ofs.write(reinterpret_cast<const char*>(&r.buildingId), sizeof(long long));
+    void reset(size_t rooms) {
+        days.clear();
+        roomCount = rooms;
     }
-    void readData(std::ifstream& ifs, Room& r) {
-        ifs.read(reinterpret_cast<char*>(&r.roomId), sizeof(long long));
-        readString(ifs, r.roomName);
-        ifs.read(reinterpret_cast<char*>(&r.buildingId), sizeof(long long));
+
+    size_t rooms() const { return roomCount; }
+
+    // Occupied-slot counts per room, weekday and hour over days in [fromKey, toKey], hours
+    // [firstHour, lastHour). cells[(room * 7 + weekday) * hours + hour - firstHour]; 12 slots = one full hour.
+    void accumulateHourly(int fromKey, int toKey, int firstHour, int lastHour, vector<uint32_t>& cells) const {
+        vector<uint64_t> hourMasks;
+        hourlyMasks(firstHour, lastHour, hourMasks);
+        cells.assign(roomCount * 7 * (lastHour - firstHour), 0);
+        for (const auto& entry : days) {
+            if (entry.first < fromKey || entry.first > toKey) continue;
+            addHourly(entry.first, entry.second, hourMasks, lastHour - firstHour, cells);
+        }
     }
 
-    // Writes/Reads LabSection 
-    void writeData(std::ofstream& ofs, const LabSection& ls) {
- 
-        ofs.write(reinterpret_cast<const char*>(&ls.courseId), sizeof(long long));
-        writeString(ofs, ls.courseCode);
-        writeString(ofs, ls.courseName);
+    // Adds the counts of every day before beforeKey to cells (laid out as accumulateHourly leaves
+    // them) and forgets those days, so a date-ordered stream of sessions needs only the open days.
+    void drainHourly(int beforeKey, int firstHour, int lastHour, vector<uint32_t>& cells) {
+        vector<uint64_t> hourMasks;
+        hourlyMasks(firstHour, lastHour, hourMasks);
+        for (auto it = days.begin(); it != days.end();) {
+            if (it->first >= beforeKey) { ++it; continue; }
+            addHourly(it->first, it->second, hourMasks, lastHour - firstHour, cells);
+            it = days.erase(it);
+        }
+    }
 
+private:
+    static void hourlyMasks(int firstHour, int lastHour, vector<uint64_t>& hourMasks) {
+        int hours = lastHour - firstHour;
+        hourMasks.assign(hours * WORDS, 0);
+        for (int h = 0; h < hours; ++h) {
+            slotMask(Time(firstHour + h, 0), Time(firstHour + h + 1, 0), &hourMasks[h * WORDS]);
+        }
+    }
 
-        ofs.write(reinterpret_cast<const char*>(&ls.sectionId), sizeof(long long));
-        writeString(ofs, ls.sectionName);
-        ofs.write(reinterpret_cast<const char*>(&ls.instructorId), sizeof(long long));
-        writeVector(ofs, ls.taIds);
+    void addHourly(int key, const DayPlanes& day, const vector<uint64_t>& hourMasks, int hours, vector<uint32_t>& cells) const {
+        int weekday = Date::weekdayOf(key % 100, key / 100 % 100, key / 10000);
+        size_t n = min(roomCount, day.inexact.size());
+        for (size_t r = 0; r < n; ++r) {
+            uint64_t w0 = day.planes[0][r], w1 = day.planes[1][r], w2 = day.planes[2][r], w3 = day.planes[3][r], w4 = day.planes[4][r];
+            if ((w0 | w1 | w2 | w3 | w4) == 0) continue;
+            uint32_t* row = &cells[(r * 7 + weekday) * hours];
+            for (int h = 0; h < hours; ++h) {
+                const uint64_t* m = &hourMasks[h * WORDS];
+                row[h] += popcount64(w0 & m[0]) + popcount64(w1 & m[1]) + popcount64(w2 & m[2])
+                    + popcount64(w3 & m[3]) + popcount64(w4 & m[4]);
+            }
+        }
     }
-    void readData(std::ifstream& ifs, LabSection& ls) {
 
-        ifs.read(reinterpret_cast<char*>(&ls.courseId), sizeof(long long));
-        readString(ifs, ls.courseCode);
-        readString(ifs, ls.courseName);
+public:
+
+    void addRoom() { roomCount++; }
 
-        ifs.read(reinterpret_cast<char*>(&ls.sectionId), sizeof(long long));
-        readString(ifs, ls.sectionName); 
-        ifs.read(reinterpret_cast<char*>(&ls.instructorId), sizeof(long long));
-        readVector(ifs, ls.taIds);
+    void mark(int dayKey, size_t room, const Time& start, const Time& end) {
+        DayPlanes& day = days[dayKey];
+        day.ensure(roomCount);
+        uint64_t mask[WORDS];
+        slotMask(start, end, mask);
+        for (int w = 0; w < WORDS; ++w) day.planes[w][room] |= mask[w];
+        if (!isAligned(start, end)) day.inexact[room] = 1;
     }
 
-    // Writes/Reads ScheduleEntry 
-    void writeData(std::ofstream& ofs, const ScheduleEntry& se) {
-        ofs.write(reinterpret_cast<const char*>(&se), sizeof(ScheduleEntry));
-    }
-    void readData(std::ifstream& ifs, ScheduleEntry& se) {
-        ifs.read(reinterpret_cast<char*>(&se), sizeof(ScheduleEntry));
+    // used before re-marking a room's remaining sessions (after a cancellation)
+    void clearRoomDay(int dayKey, size_t room) {
+        auto it = days.find(dayKey);
+        if (it == days.end() || room >= it->second.inexact.size()) return;
+        for (auto& p : it->second.planes) p[room] = 0;
+        it->second.inexact[room] = 0;
     }
 
-    // Writes/Reads MakeupRequest 
-    void writeData(std::ofstream& ofs, const MakeupRequest& mr) {
-        ofs.write(reinterpret_cast<const char*>(&mr.requestId), sizeof(long long));
-        ofs.write(reinterpret_cast<const char*>(&mr.sectionId), sizeof(long long));
-        ofs.write(reinterpret_cast<const char*>(&mr.instructorId), sizeof(long long));
-        ofs.write(reinterpret_cast<const char*>(&mr.requestedDate), sizeof(Date));
-        ofs.write(reinterpret_cast<const char*>(&mr.requestedStart), sizeof(Time));
-        ofs.write(reinterpret_cast<const char*>(&mr.requestedEnd), sizeof(Time));
-        writeString(ofs, mr.reason);
-        ofs.write(reinterpret_cast<const char*>(&mr.status), sizeof(int));
-    }
-    void readData(std::ifstream& ifs, MakeupRequest& mr) {
-        ifs.read(reinterpret_cast<char*>(&mr.requestId), sizeof(long long));
-        ifs.read(reinterpret_cast<char*>(&mr.sectionId), sizeof(long long));
-        ifs.read(reinterpret_cast<char*>(&mr.instructorId), sizeof(long long));
-        ifs.read(reinterpret_cast<char*>(&mr.requestedDate), sizeof(Date));
-        ifs.read(reinterpret_cast<char*>(&mr.requestedStart), sizeof(Time));
-        ifs.read(reinterpret_cast<char*>(&mr.requestedEnd), sizeof(Time));
-        readString(ifs, mr.reason);
-        ifs.read(reinterpret_cast<char*>(&mr.status), sizeof(int));
+    // fills state[r] with FREE, BUSY or CHECK (bitmap overlaps, exact times must decide)
+    void scan(int dayKey, const Time& start, const Time& end, vector<uint8_t>& state) const {
+        state.assign(roomCount, FREE);
+        auto it = days.find(dayKey);
+        if (it == days.end()) return;
+        const DayPlanes& day = it->second;
+        size_t n = min(roomCount, day.inexact.size());
+
+        uint64_t mask[WORDS];
+        slotMask(start, end, mask);
+        const uint64_t* p0 = day.planes[0].data();
+        const uint64_t* p1 = day.planes[1].data();
+        const uint64_t* p2 = day.planes[2].data();
+        const uint64_t* p3 = day.planes[3].data();
+        const uint64_t* p4 = day.planes[4].data();
+        uint8_t* out = state.data();
+        size_t r = 0;
+
+#if defined(__AVX2__)
+        const __m256i m0 = _mm256_set1_epi64x((long long)mask[0]), m1 = _mm256_set1_epi64x((long long)mask[1]),
+            m2 = _mm256_set1_epi64x((long long)mask[2]), m3 = _mm256_set1_epi64x((long long)mask[3]),
+            m4 = _mm256_set1_epi64x((long long)mask[4]);
+        const __m256i zero = _mm256_setzero_si256();
+        for (; r + 4 <= n; r += 4) {
+            __m256i acc = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p0 + r)), m0);
+            acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p1 + r)), m1));
+            acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p2 + r)), m2));
+            acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p3 + r)), m3));
+            acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p4 + r)), m4));
+            int freeBits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(acc, zero)));
+            out[r] = freeBits & 1;
+            out[r + 1] = (freeBits >> 1) & 1;
+            out[r + 2] = (freeBits >> 2) & 1;
+            out[r + 3] = (freeBits >> 3) & 1;
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i m0 = _mm_set1_epi64x((long long)mask[0]), m1 = _mm_set1_epi64x((long long)mask[1]),
+            m2 = _mm_set1_epi64x((long long)mask[2]), m3 = _mm_set1_epi64x((long long)mask[3]),
+            m4 = _mm_set1_epi64x((long long)mask[4]);
+        const __m128i zero = _mm_setzero_si128();
+        for (; r + 2 <= n; r += 2) {
+            __m128i acc = _mm_and_si128(_mm_loadu_si128((const __m128i*)(p0 + r)), m0);
+            acc = _mm_or_si128(acc, _mm_and_si128(_mm_loadu_si128((const __m128i*)(p1 + r)), m1));
+            acc = _mm_or_si128(acc, _mm_and_si128(_mm_loadu_si128((const __m128i*)(p2 + r)), m2));
+            acc = _mm_or_si128(acc, _mm_and_si128(_mm_loadu_si128((const __m128i*)(p3 + r)), m3));
+            acc = _mm_or_si128(acc, _mm_and_si128(_mm_loadu_si128((const __m128i*)(p4 + r)), m4));
+            int zeroBytes = _mm_movemask_epi8(_mm_cmpeq_epi32(acc, zero));
+            out[r] = (zeroBytes & 0xFF) == 0xFF;
+            out[r + 1] = (zeroBytes >> 8) == 0xFF;
+        }
+#endif
+        for (; r < n; ++r) {
+            uint64_t acc = (p0[r] & mask[0]) | (p1[r] & mask[1]) | (p2[r] & mask[2]) | (p3[r] & mask[3]) | (p4[r] & mask[4]);
+            out[r] = acc == 0;
+        }
+
+        bool exactQuery = isAligned(start, end);
+        for (r = 0; r < n; ++r) {
+            if (out[r] == BUSY && (!exactQuery || day.inexact[r])) out[r] = CHECK;
+        }
     }
+};
 
+// schedule queries
 
+// A filter over schedule entries; each setter narrows it and unset fields match everything.
+// DataManager::select plans and runs it.
+class ScheduleQuery {
+public:
+    int fromKey = 0;        // date keys (YYYYMMDD), inclusive
+    int toKey = 99991231;
+    int sectionId = 0;
+    int roomId = 0;
+    int buildingId = 0;
+    int attendantId = 0;    // rooms in the buildings this attendant manages
+    int instructorId = 0;
+    int taId = 0;
+    int status = -1;        // 0: Scheduled, 1: Timesheet Filled, 2: Canceled; -1: any
+    int makeup = -1;        // 1: makeup sessions only, 0: regular sessions only; -1: any
+
+    ScheduleQuery& between(const Date& from, const Date& to) { fromKey = from.toKey(); toKey = to.toKey(); return *this; }
+    ScheduleQuery& forSection(int id) { sectionId = id; return *this; }
+    ScheduleQuery& inRoom(int id) { roomId = id; return *this; }
+    ScheduleQuery& inBuilding(int id) { buildingId = id; return *this; }
+    ScheduleQuery& forAttendant(int id) { attendantId = id; return *this; }
+    ScheduleQuery& forInstructor(int id) { instructorId = id; return *this; }
+    ScheduleQuery& forTA(int id) { taId = id; return *this; }
+    ScheduleQuery& withStatus(int s) { status = s; return *this; }
+    ScheduleQuery& makeupOnly(bool m) { makeup = m ? 1 : 0; return *this; }
+};
 
-    template <typename T>
-    std::vector<T> readAllRecords(const std::string& filename) {
-        std::vector<T> records;
-        std::ifstream ifs(filename, std::ios::binary | std::ios::in);
-        if (!ifs) return records;
+// place in a date-ordered walk over the schedules: a date key and how many of that day's
+// sessions are already behind it
+struct ScheduleCursor {
+    int dateKey = 0;
+    size_t skip = 0;
+};
 
-        while (ifs.peek() != std::ifstream::traits_type::eof()) {
-            T record;
-            readData(ifs, record);
-            if (!ifs.fail()) {
-                records.push_back(record);
-            }
-            else {
-                break; 
-            }
-        }
-        ifs.close();
-        return records;
+// The positions in a ScheduleStore that match a query, in schedule order. The planner hands it
+// the candidate positions of one index (or none, for a full scan) plus the query with sections
+// and rooms already resolved; every predicate is checked on the hot columns while the range is
+// iterated, so nothing is copied out for entries that do not match. Valid until schedules change.
+class ScheduleRange {
+public:
+    enum Plan { EMPTY, FULL_SCAN, DATE_INDEX, SECTION_INDEX, ROOM_INDEX };
+
+private:
+    const ScheduleStore* store;
+    Plan plan;
+    vector<int> candidates;         // ascending positions; unused by a full scan
+    int fromKey, toKey, status, makeup;
+    bool anySection, anyRoom;
+    vector<int> sections, rooms;    // sorted allowed ids when restricted
+
+    size_t limit() const { return plan == FULL_SCAN ? store->size() : candidates.size(); }
+    size_t positionAt(size_t i) const { return plan == FULL_SCAN ? i : (size_t)candidates[i]; }
+
+    bool matches(size_t pos) const {
+        int key = store->dateKey(pos);
+        if (key < fromKey || key > toKey) return false;
+        if (status >= 0 && store->status(pos) != status) return false;
+        if (!anySection && !binary_search(sections.begin(), sections.end(), store->sectionId(pos))) return false;
+        if (!anyRoom && !binary_search(rooms.begin(), rooms.end(), store->roomId(pos))) return false;
+        return makeup < 0 || store->isMakeup(pos) == (makeup == 1);
     }
 
-    template <typename T>
-    bool saveRecord(const std::string& filename, const T& record) {
-        std::ofstream ofs(filename, std::ios::binary | std::ios::app);
-        if (!ofs.is_open()) {
-            std::cerr << "ERROR: Could not open file " << filename << " for saving." << std::endl;
-            return false;
+public:
+    class const_iterator {
+    private:
+        const ScheduleRange* range;
+        size_t i;
+
+        void settle() {
+            while (i < range->limit() && !range->matches(range->positionAt(i))) ++i;
         }
-        writeData(ofs, record);
-        ofs.close();
-        return true;
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef size_t value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const size_t* pointer;
+        typedef size_t reference;
+
+        const_iterator(const ScheduleRange* r, size_t index) : range(r), i(index) { settle(); }
+        size_t operator*() const { return range->positionAt(i); }
+        const_iterator& operator++() { ++i; settle(); return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+        bool operator==(const const_iterator& other) const { return i == other.i; }
+        bool operator!=(const const_iterator& other) const { return i != other.i; }
+    };
+
+    ScheduleRange(const ScheduleStore& s, Plan p, vector<int> positions, const ScheduleQuery& q,
+        bool allSections, vector<int> sectionIds, bool allRooms, vector<int> roomIds)
+        : store(&s), plan(p), candidates(move(positions)), fromKey(q.fromKey), toKey(q.toKey),
+        status(q.status), makeup(q.makeup), anySection(allSections), anyRoom(allRooms),
+        sections(move(sectionIds)), rooms(move(roomIds)) {
+        if (plan == EMPTY) candidates.clear();
+        else if (!is_sorted(candidates.begin(), candidates.end())) sort(candidates.begin(), candidates.end());
     }
 
-    template <typename T>
-    bool saveAllRecords(const std::string& filename, const std::vector<T>& records) {
-        std::ofstream ofs(filename, std::ios::binary | std::ios::out | std::ios::trunc);
-        if (!ofs.is_open()) {
-            std::cerr << "ERROR: Could not open file " << filename << " for overwriting." << std::endl;
-            return false;
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, limit()); }
+    bool empty() const { return begin() == end(); }
+    // whether the query matches position pos, for walks in some other order
+    bool contains(size_t pos) const { return plan != EMPTY && pos < store->size() && matches(pos); }
+
+    Plan getPlan() const { return plan; }
+    // entries the iteration will look at, matching or not
+    size_t visited() const { return limit(); }
+
+    static const char* planName(Plan p) {
+        switch (p) {
+        case EMPTY: return "empty";
+        case FULL_SCAN: return "full scan";
+        case DATE_INDEX: return "date index";
+        case SECTION_INDEX: return "section index";
+        case ROOM_INDEX: return "room index";
         }
-        for (const auto& record : records) {
-            writeData(ofs, record);
-        }
-        ofs.close();
-        return true;
+        return "?";
     }
+};
 
 
+// manager classes
+
+// storage engines
 
+// Where DataManager keeps its files. Files are named flat ("schedules.dat") and an engine decides
+// where the bytes live, so storage experiments need no change to DataManager's callers. Every
+// call may come from several threads at once (history pages are read on the cache's I/O thread).
+class StorageEngine {
 public:
-    
-    static int nextCourseId;
+    virtual ~StorageEngine() {}
+    virtual string describe() const = 0;
+    // the whole file; false if it does not exist
+    virtual bool read(const string& name, string& bytes) = 0;
+    // up to size bytes from offset; returns the number read (0 past the end or if missing)
+    virtual size_t readAt(const string& name, size_t offset, char* buffer, size_t size) = 0;
+    // write replaces the file, append creates it if needed; false on an I/O error
+    virtual bool write(const string& name, const char* data, size_t size) = 0;
+    virtual bool append(const string& name, const char* data, size_t size) = 0;
+    // bytes in the file, -1 if it does not exist
+    virtual long long size(const string& name) = 0;
+    // replaces to if it exists
+    virtual bool rename(const string& from, const string& to) = 0;
+    virtual bool remove(const string& name) = 0;
+    virtual vector<string> list() = 0;
+
+    // the engine a DataManager uses when none is passed in: the data directory (see main)
+    static shared_ptr<StorageEngine>& standard();
+};
 
-    vector<Person> persons;
-    vector<Room> rooms;
-    vector<LabSection> labSections;
-    vector<ScheduleEntry> schedules;
-    vector<MakeupRequest> requests;
-    vector<Building> buildings;
+// files in one directory ("" for the working directory)
+class FileEngine : public StorageEngine {
+private:
+    string directory;
 
+    string path(const string& name) const { return directory.empty() ? name : directory + "/" + name; }
 
-    int getNextId(int& staticIdCounter) {
-        return ++staticIdCounter;
+public:
+    explicit FileEngine(const string& dir = "") : directory(dir) {}
+
+    string describe() const override { return "file"; }
+
+    bool read(const string& name, string& bytes) override {
+        std::ifstream ifs(path(name), std::ios::binary);
+        if (!ifs) return false;
+        ifs.seekg(0, std::ios::end);
+        bytes.resize((size_t)ifs.tellg());
+        ifs.seekg(0, std::ios::beg);
+        ifs.read(&bytes[0], bytes.size());
+        return true;
     }
 
-    DataManager() {
-        loadAllData();
+    size_t readAt(const string& name, size_t offset, char* buffer, size_t size) override {
+        std::ifstream ifs(path(name), std::ios::binary);
+        if (!ifs.seekg((streamoff)offset)) return 0;
+        ifs.read(buffer, size);
+        return (size_t)ifs.gcount();
     }
 
-    void loadAllData() {
-        persons = readAllRecords<Person>(PERSONS_FILE);
-        rooms = readAllRecords<Room>(ROOMS_FILE);
-        labSections = readAllRecords<LabSection>(LABS_FILE);
-        schedules = readAllRecords<ScheduleEntry>(SCHEDULES_FILE);
-        requests = readAllRecords<MakeupRequest>(MAKEUP_FILE);
-        buildings = readAllRecords<Building>(BUILDINGS_FILE);
+    bool write(const string& name, const char* data, size_t size) override {
+        std::ofstream ofs(path(name), std::ios::binary | std::ios::trunc);
+        return ofs.is_open() && ofs.write(data, size);
+    }
 
-        // Update static ID counters based on loaded data
-        for (const auto& p : persons) if (p.personId > nextPersonId) nextPersonId = p.personId;
-        for (const auto& r : rooms) if (r.roomId > nextRoomId) nextRoomId = r.roomId;
-        for (const auto& l : labSections) {
-            if (l.sectionId > nextLabSectionId) nextLabSectionId = l.sectionId;
-            // Update nextCourseId based on the highest CourseId found in sections
-            if (l.courseId > nextCourseId) nextCourseId = l.courseId;
-        }
-        for (const auto& s : schedules) if (s.scheduleId > nextScheduleId) nextScheduleId = s.scheduleId;
-        for (const auto& m : requests) if (m.requestId > nextMakeupId) nextMakeupId = m.requestId;
-        for (const auto& b : buildings) if (b.buildingId > nextBuildingId) nextBuildingId = b.buildingId;
+    bool append(const string& name, const char* data, size_t size) override {
+        std::ofstream ofs(path(name), std::ios::binary | std::ios::app);
+        return ofs.is_open() && ofs.write(data, size);
     }
 
+    long long size(const string& name) override {
+        std::ifstream ifs(path(name), std::ios::binary | std::ios::ate);
+        return ifs ? (long long)ifs.tellg() : -1;
+    }
 
-    static void initializeStaticIds() {
-        nextPersonId = 1000;
-        nextLabSectionId = 2000;
-        nextRoomId = 3000;
-        nextScheduleId = 4000;
-        nextMakeupId = 5000;
-        nextBuildingId = 6000;
-        nextCourseId = 7000; \
+    // replaces to in one step, so a reader sees either the old file or the new one
+    bool rename(const string& from, const string& to) override {
+#ifdef _WIN32
+        return MoveFileExA(path(from).c_str(), path(to).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(path(from).c_str(), path(to).c_str()) == 0;
+#endif
     }
 
-    // person management
-    int addPerson(const string& name, const string& role, const string& password) {
-        int newId = getNextId(nextPersonId);
-        Person p(newId, name, role, password);
-        persons.push_back(p);
-        saveRecord(PERSONS_FILE, p);
-        return newId;
+    bool remove(const string& name) override { return std::remove(path(name).c_str()) == 0; }
+
+    vector<string> list() override {
+        vector<string> names;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(directory.empty() ? "." : directory, ec)) {
+            if (entry.is_regular_file()) names.push_back(entry.path().filename().string());
+        }
+        return names;
     }
+};
 
-    // venue management
-    int addBuilding(const string& name, const string& address, int attendantId) {
-        int newId = getNextId(nextBuildingId);
-        Building b(newId, name, address, attendantId);
-        buildings.push_back(b);
-        saveRecord(BUILDINGS_FILE, b);
-        return newId;
+// Files kept in process memory and lost at exit; for benchmarks and tests that should not
+// touch the disk or measure it.
+class MemoryEngine : public StorageEngine {
+private:
+    map<string, string> files;
+    mutex lock;
+
+public:
+    string describe() const override { return "memory"; }
+
+    bool read(const string& name, string& bytes) override {
+        lock_guard<mutex> guard(lock);
+        auto it = files.find(name);
+        if (it == files.end()) return false;
+        bytes = it->second;
+        return true;
     }
 
-    int addRoom(const string& roomName, int buildingId) {
-        int newId = getNextId(nextRoomId);
-        Room r(newId, roomName, buildingId);
-        rooms.push_back(r);
-        saveRecord(ROOMS_FILE, r);
-        return newId;
+    size_t readAt(const string& name, size_t offset, char* buffer, size_t size) override {
+        lock_guard<mutex> guard(lock);
+        auto it = files.find(name);
+        if (it == files.end() || offset >= it->second.size()) return 0;
+        size_t n = min(size, it->second.size() - offset);
+        memcpy(buffer, it->second.data() + offset, n);
+        return n;
     }
 
-    // lab section management
+    bool write(const string& name, const char* data, size_t size) override {
+        lock_guard<mutex> guard(lock);
+        files[name].assign(data, size);
+        return true;
+    }
 
+    bool append(const string& name, const char* data, size_t size) override {
+        lock_guard<mutex> guard(lock);
+        files[name].append(data, size);
+        return true;
+    }
 
-    int addLabSection(int courseId, const string& courseCode, const string& courseName, const string& sectionName) {
-        int newId = getNextId(nextLabSectionId);
-        LabSection ls(courseId, courseCode, courseName, newId, sectionName);
-        labSections.push_back(ls);
-        saveRecord(LABS_FILE, ls);
-        return newId;
+    long long size(const string& name) override {
+        lock_guard<mutex> guard(lock);
+        auto it = files.find(name);
+        return it == files.end() ? -1 : (long long)it->second.size();
     }
 
-    bool assignInstructor(long long sectionId, long long insId) {
-        for (auto& ls : labSections) {
-            if (ls.sectionId == sectionId) {
-                ls.instructorId = insId;
-                return saveAllRecords(LABS_FILE, labSections);
-            }
-        }
-        return false;
+    bool rename(const string& from, const string& to) override {
+        lock_guard<mutex> guard(lock);
+        auto it = files.find(from);
+        if (it == files.end()) return false;
+        string bytes = move(it->second);
+        files.erase(it);
+        files[to] = move(bytes);
+        return true;
     }
 
-    bool assignTA(int sectionId, int taId) {
-        for (auto& ls : labSections) {
-            if (ls.sectionId == sectionId) {
-                ls.addTA(taId);
-                return saveAllRecords(LABS_FILE, labSections);
-            }
-        }
-        return false;
+    bool remove(const string& name) override {
+        lock_guard<mutex> guard(lock);
+        return files.erase(name) > 0;
     }
 
-    //Scheduling Management
-    int addScheduleEntry(int sectionId, int roomId, const Date& date, const Time& start, const Time& end, bool isMakeup = false) {
-        int newId = getNextId(nextScheduleId);
-        ScheduleEntry se(newId, sectionId, roomId, date, start, end, isMakeup);
-        schedules.push_back(se);
-        saveRecord(SCHEDULES_FILE, se);
-        return newId;
+    vector<string> list() override {
+        lock_guard<mutex> guard(lock);
+        vector<string> names;
+        for (const auto& f : files) names.push_back(f.first);
+        return names;
     }
+};
 
-    bool updateScheduleActualTime(int scheduleId, const Time& actualStart, const Time& actualEnd) {
-        for (auto& se : schedules) {
-            if (se.scheduleId == scheduleId) {
-                se.actualStart = actualStart;
-                se.actualEnd = actualEnd;
-                se.status = 1; // 1: Timesheet Filled
-                return saveAllRecords(SCHEDULES_FILE, schedules);
-            }
-        }
-        return false;
+inline shared_ptr<StorageEngine>& StorageEngine::standard() {
+    static shared_ptr<StorageEngine> engine = make_shared<FileEngine>();
+    return engine;
+}
+
+// change data capture
+
+enum class ChangeTable : uint8_t { Person = 1, Building, Room, Course, LabSection, Schedule, MakeupRequest, Holiday };
+enum class ChangeKind : uint8_t { Insert = 1, Update, Archive };
+
+inline const char* changeTableName(ChangeTable t) {
+    switch (t) {
+    case ChangeTable::Person: return "person";
+    case ChangeTable::Building: return "building";
+    case ChangeTable::Room: return "room";
+    case ChangeTable::Course: return "course";
+    case ChangeTable::LabSection: return "section";
+    case ChangeTable::Schedule: return "schedule";
+    case ChangeTable::MakeupRequest: return "makeup";
+    case ChangeTable::Holiday: return "holiday";
     }
+    return "?";
+}
+
+inline const char* changeKindName(ChangeKind k) {
+    return k == ChangeKind::Insert ? "insert" : k == ChangeKind::Update ? "update" : k == ChangeKind::Archive ? "archive" : "?";
+}
+
+// One mutation. Inserts and updates carry the record as it is after the change, encoded with the
+// table's RecordSchema in the given format, so applying an event twice is harmless. An Archive
+// event has no record; its id is the cutoff date key passed to archiveSemestersBefore.
+struct ChangeEvent {
+    uint64_t sequence = 0;
+    ChangeTable table = ChangeTable::Person;
+    ChangeKind kind = ChangeKind::Insert;
+    uint8_t format = 0;
+    int id = 0;
+    string record;
+};
 
-    // Makeup Request Management
-    int addMakeupRequest(int sectionId, int instructorId, const Date& date, const Time& start, const Time& end, const string& reason) {
-        int newId = getNextId(nextMakeupId);
-        MakeupRequest mr(newId, sectionId, instructorId, date, start, end, reason);
-        requests.push_back(mr);
-        saveRecord(MAKEUP_FILE, mr);
-        return newId;
+// where a consumer is in the change log: the byte offset of the next event and the last
+// sequence number it has seen; consumers persist both to resume
+struct ChangeCursor {
+    uint64_t offset = 0;
+    uint64_t sequence = 0;
+};
+
+// Append-only change log (changes.log in the data directory). After the "LMS" header each event is
+// a uint32 body length, the body (uint64 sequence, table, kind, format, int id, record) and the
+// length again. The trailing copy lets the writer find the last sequence number without a scan
+// and lets readers tell a complete event from one still being appended.
+class ChangeLog {
+private:
+    static const size_t HEADER_BYTES = 4;
+    static const size_t FIXED_BYTES = 8 + 3 + 4;
+    StorageEngine* storage = nullptr;
+    uint64_t lastSequence = 0;
+    bool started = false; // the file exists and has its header
+    string pending;       // encoded events not yet appended
+
+    static bool parse(const char* p, size_t available, ChangeEvent& e, size_t& used) {
+        uint32_t length = 0, trailer = 0;
+        if (available < 4) return false;
+        memcpy(&length, p, 4);
+        if (length < FIXED_BYTES || available < 8 + (size_t)length) return false;
+        memcpy(&trailer, p + 4 + length, 4);
+        if (trailer != length) return false;
+        const char* body = p + 4;
+        memcpy(&e.sequence, body, 8);
+        e.table = (ChangeTable)body[8];
+        e.kind = (ChangeKind)body[9];
+        e.format = (uint8_t)body[10];
+        memcpy(&e.id, body + 11, 4);
+        e.record.assign(body + FIXED_BYTES, length - FIXED_BYTES);
+        used = 8 + length;
+        return true;
     }
 
-    bool updateMakeupRequestStatus(int requestId, int status) {
-        for (auto& mr : requests) {
-            if (mr.requestId == requestId) {
-                mr.status = status;
-                return saveAllRecords(MAKEUP_FILE, requests);
-            }
-        }
-        return false;
+public:
+    static const string FILE_NAME;
+
+    // Picks up the sequence numbers where the log ends. A torn last event (a crash mid-append)
+    // is cut off so new events follow the last complete one.
+    void open(StorageEngine& engine) {
+        storage = &engine;
+        pending.clear();
+        long long size = storage->size(FILE_NAME);
+        ChangeCursor tail = end(engine);
+        lastSequence = tail.sequence;
+        started = size >= (long long)HEADER_BYTES;
+        if (size <= (long long)tail.offset) return;
+        cout << "[ERROR] " << FILE_NAME << " ended in an incomplete event; it was cut after event " << lastSequence << "." << endl;
+        string bytes;
+        storage->read(FILE_NAME, bytes);
+        storage->write(FILE_NAME, bytes.data(), (size_t)tail.offset);
     }
 
-    const Person* getPersonById(int id) const {
-        for (const auto& p : persons) {
-            if (p.personId == id) return &p;
-        }
-        return nullptr;
+    uint64_t lastSequenceNumber() const { return lastSequence; }
+
+    // queues one event; it reaches the log at the next flush()
+    void add(ChangeTable table, ChangeKind kind, uint8_t format, int id, const string& record) {
+        uint32_t length = (uint32_t)(FIXED_BYTES + record.size());
+        uint64_t sequence = ++lastSequence;
+        pending.append((const char*)&length, 4);
+        pending.append((const char*)&sequence, 8);
+        pending.push_back((char)table);
+        pending.push_back((char)kind);
+        pending.push_back((char)format);
+        pending.append((const char*)&id, 4);
+        pending += record;
+        pending.append((const char*)&length, 4);
     }
 
-    const LabSection* getLabSectionById(int id) const {
-        for (const auto& ls : labSections) {
-            if (ls.sectionId == id) return &ls;
+    // Appends the queued events. If the append fails they stay queued for the next flush, and
+    // anything a partial write left behind is cut off so the log still ends on a whole event.
+    bool flush() {
+        if (pending.empty() || !storage) return true;
+        if (!started) pending.insert(0, "LMS\x01", HEADER_BYTES);
+        long long before = max(0LL, storage->size(FILE_NAME));
+        if (!storage->append(FILE_NAME, pending.data(), pending.size())) {
+            cout << "[ERROR] Could not append to " << FILE_NAME << endl;
+            if (!started) pending.erase(0, HEADER_BYTES);
+            if (storage->size(FILE_NAME) > before) {
+                string bytes;
+                storage->read(FILE_NAME, bytes);
+                storage->write(FILE_NAME, bytes.data(), (size_t)before);
+            }
+            return false;
         }
-        return nullptr;
+        started = true;
+        SystemStats::FileCounters& counters = SystemStats::instance().file(FILE_NAME);
+        counters.bytesWritten += pending.size();
+        counters.appends++;
+        pending.clear();
+        return true;
     }
 
-    const Room* getRoomById(int id) const {
-        for (const auto& r : rooms) {
-            if (r.roomId == id) return &r;
+    // Consumer side: appends the complete events after cursor to events (about maxBytes of them)
+    // and moves the cursor past them. Returns the number read; 0 means the consumer is caught up.
+    static size_t read(StorageEngine& engine, ChangeCursor& cursor, vector<ChangeEvent>& events, size_t maxBytes = 1 << 20) {
+        if (cursor.offset < HEADER_BYTES) cursor.offset = HEADER_BYTES;
+        string chunk(maxBytes, '\0');
+        size_t got = engine.readAt(FILE_NAME, (size_t)cursor.offset, &chunk[0], chunk.size());
+        uint32_t length = 0;
+        if (got >= 4) memcpy(&length, chunk.data(), 4);
+        if (got >= 4 && (size_t)length + 8 > got) { // one event larger than the chunk
+            chunk.resize((size_t)length + 8);
+            got = engine.readAt(FILE_NAME, (size_t)cursor.offset, &chunk[0], chunk.size());
         }
-        return nullptr;
+        size_t at = 0, count = 0, used = 0;
+        ChangeEvent e;
+        while (parse(chunk.data() + at, got - at, e, used)) {
+            at += used;
+            cursor.sequence = e.sequence;
+            events.push_back(e);
+            count++;
+        }
+        cursor.offset += at;
+        return count;
     }
 
-    const Building* getBuildingById(int id) const {
-        for (const auto& b : buildings) {
-            if (b.buildingId == id) return &b;
+    // a cursor after the last complete event; only reads the whole log if its tail is torn
+    static ChangeCursor end(StorageEngine& engine) {
+        ChangeCursor cursor;
+        cursor.offset = HEADER_BYTES;
+        long long size = engine.size(FILE_NAME);
+        if (size <= (long long)HEADER_BYTES) return cursor;
+        uint32_t length = 0;
+        if (engine.readAt(FILE_NAME, (size_t)size - 4, (char*)&length, 4) == 4 && (long long)(length + 8 + HEADER_BYTES) <= size) {
+            string tail(length + 8, '\0');
+            engine.readAt(FILE_NAME, (size_t)size - length - 8, &tail[0], tail.size());
+            ChangeEvent e;
+            size_t used = 0;
+            if (parse(tail.data(), tail.size(), e, used)) {
+                cursor.offset = (uint64_t)size;
+                cursor.sequence = e.sequence;
+                return cursor;
+            }
         }
-        return nullptr;
+        return seek(engine, UINT64_MAX);
     }
 
-    const vector<Room>& getRooms() const { return rooms; }
-    const vector<Building>& getBuildings() const { return buildings; }
-    const vector<LabSection>& getLabSections() const { return labSections; }
-    const vector<ScheduleEntry>& getSchedules() const { return schedules; }
-    const vector<MakeupRequest>& getRequests() const { return requests; }
-
-    bool isRoomAvailable(int roomId, const Date& date, const Time& start, const Time& end) const {
-        for (const auto& se : schedules) {
-            if (se.roomId == roomId && se.scheduledDate == date) {
-                if (se.expectedStart < end && start < se.expectedEnd && !se.isCanceled) {
-                    return false; 
-                }
+    // a cursor just past event number sequence, found by reading the log from the start
+    static ChangeCursor seek(StorageEngine& engine, uint64_t sequence) {
+        ChangeCursor cursor;
+        cursor.offset = HEADER_BYTES;
+        vector<ChangeEvent> events;
+        while (true) {
+            ChangeCursor before = cursor;
+            events.clear();
+            if (read(engine, cursor, events) == 0) return cursor;
+            if (events.back().sequence < sequence) continue;
+            for (const auto& e : events) {
+                if (e.sequence > sequence) return before;
+                before.offset += FIXED_BYTES + e.record.size() + 8;
+                before.sequence = e.sequence;
             }
+            return before;
         }
-        return true; 
     }
 };
 
+const string ChangeLog::FILE_NAME = "changes.log";
 
-int DataManager::nextPersonId = 1000;
-int DataManager::nextLabSectionId = 2000;
-int DataManager::nextRoomId = 3000;
-int DataManager::nextScheduleId = 4000;
-int DataManager::nextMakeupId = 5000;
-int DataManager::nextBuildingId = 6000;
-int DataManager::nextCourseId = 7000; 
-
-// authentication
-class Authentication {
-private:
-    DataManager& dm;
+// search index
 
+// Type-ahead search over the names records are looked up by: person names, course codes and
+// names, room and building names. Text is folded to lower case and split into words. Each
+// word's trigrams point to the documents that contain it, and the words themselves are kept
+// sorted. A query word of three or more letters starts from its rarest trigram; a shorter one
+// starts from the words it prefixes and must itself begin a word. Only the smallest candidate
+// list is checked against the folded text, so a query costs about the size of its rarest term's
+// list, not the record count.
+// Documents are only appended; re-adding a record under a new name leaves a dead document behind.
+class SearchIndex {
 public:
-    Authentication(DataManager& dataManager) : dm(dataManager) {}
+    struct Hit {
+        ChangeTable table;
+        int id;
+        int score;
+        string text;
+    };
 
-    const Person* authenticate(long long id, const std::string& password) const {
-        const Person* p = dm.getPersonById(id);
-        if (p && password == p->password) {
-            return p;
+private:
+    struct Document {
+        ChangeTable table;
+        int id;
+        bool live;
+        string text;   // as given
+        string folded; // " word word ": lower case, single spaces, padded so words can be matched whole
+    };
+
+    vector<Document> documents;
+    unordered_map<uint64_t, int> byRecord;         // (table, id) -> live document
+    unordered_map<uint32_t, vector<int>> trigrams; // ascending document numbers
+    map<string, vector<int>> words;
+
+    static vector<string> split(const string& text) {
+        vector<string> parts;
+        string word;
+        for (char c : text) {
+            if (isalnum((unsigned char)c)) word += (char)tolower((unsigned char)c);
+            else if (!word.empty()) {
+                parts.push_back(word);
+                word.clear();
+            }
         }
-        return nullptr;
+        if (!word.empty()) parts.push_back(word);
+        return parts;
     }
-};
-
-class LabManagementSystem;
-
-// reports
 
-class HoDReportGenerator {
-private:
-    DataManager& dm;
+    static uint32_t trigramAt(const string& word, size_t i) {
+        return (uint32_t)(unsigned char)word[i] << 16 | (uint32_t)(unsigned char)word[i + 1] << 8 | (unsigned char)word[i + 2];
+    }
 
-    bool writeReportFile(const std::string& filename, const string& content) const {
-        time_t now = time(0);
-        tm temp{};
-        tm* ltm = &temp;
+    static void post(vector<int>& list, int doc) {
+        if (list.empty() || list.back() != doc) list.push_back(doc);
+    }
 
-        if (localtime_s(ltm, &now) != 0) {
-            std::cerr << "\n[ERROR] Failed to get local time." << std::endl;
-            return false;
+    // size of candidates(term), or an upper bound on it, without building the list
+    size_t candidateCount(const string& term) const {
+        size_t count = SIZE_MAX;
+        if (term.size() >= 3) {
+            for (size_t i = 0; i + 3 <= term.size(); ++i) {
+                auto it = trigrams.find(trigramAt(term, i));
+                count = min(count, it == trigrams.end() ? (size_t)0 : it->second.size());
+            }
+            return count;
         }
+        count = 0;
+        for (auto it = words.lower_bound(term); it != words.end() && it->first.compare(0, term.size(), term) == 0; ++it) {
+            count += it->second.size();
+        }
+        return count;
+    }
 
-        stringstream datedName;
-        datedName << filename << "_" << ltm->tm_year + 1900 << "-" << ltm->tm_mon + 1 << "-" << ltm->tm_mday << ".txt";
-
-        ofstream file(datedName.str());
-        if (file.is_open()) {
-            file << content;
-            file.close();
-            cout << "\n[SUCCESS] Report generated: " << datedName.str() << endl;
-            return true;
+    // documents that may contain term: a superset for long terms, exact for short ones
+    vector<int> candidates(const string& term) const {
+        vector<int> docs;
+        if (term.size() >= 3) {
+            const vector<int>* rarest = nullptr;
+            for (size_t i = 0; i + 3 <= term.size(); ++i) {
+                auto it = trigrams.find(trigramAt(term, i));
+                if (it == trigrams.end()) return docs;
+                if (!rarest || it->second.size() < rarest->size()) rarest = &it->second;
+            }
+            return *rarest;
         }
-        else {
-            cout << "\n[ERROR] Could not generate report file: " << datedName.str() << endl;
-            return false;
+        for (auto it = words.lower_bound(term); it != words.end() && it->first.compare(0, term.size(), term) == 0; ++it) {
+            docs.insert(docs.end(), it->second.begin(), it->second.end());
         }
+        sort(docs.begin(), docs.end());
+        docs.erase(unique(docs.begin(), docs.end()), docs.end());
+        return docs;
     }
 
 public:
-    HoDReportGenerator(DataManager& dataManager) : dm(dataManager) {}
+    void clear() {
+        documents.clear();
+        byRecord.clear();
+        trigrams.clear();
+        words.clear();
+    }
+
+    // adds or renames the document for (table, id)
+    void add(ChangeTable table, int id, const string& text) {
+        uint64_t key = (uint64_t)table << 32 | (uint32_t)id;
+        auto it = byRecord.find(key);
+        if (it != byRecord.end()) {
+            if (documents[it->second].text == text) return;
+            documents[it->second].live = false;
+        }
+        int doc = (int)documents.size();
+        vector<string> parts = split(text);
+        string folded = " ";
+        for (const string& w : parts) folded += w + " ";
+        documents.push_back(Document{ table, id, true, text, folded });
+        byRecord[key] = doc;
+        for (const string& w : parts) {
+            post(words[w], doc);
+            for (size_t i = 0; i + 3 <= w.size(); ++i) post(trigrams[trigramAt(w, i)], doc);
+        }
+    }
+
+    size_t size() const { return byRecord.size(); }
+
+    // Up to limit documents that contain every word of query (as a substring of some word),
+    // restricted to one table unless only is 0. Best first: a whole-word match scores 3, a word
+    // prefix 2 and any other substring 1, summed over the query words; ties go to shorter text.
+    vector<Hit> find(const string& query, size_t limit, ChangeTable only = (ChangeTable)0) const {
+        vector<Hit> hits;
+        vector<string> terms = split(query);
+        if (terms.empty() || limit == 0) return hits;
+        size_t driverTerm = 0, driverCount = SIZE_MAX;
+        for (size_t t = 0; t < terms.size(); ++t) {
+            size_t count = candidateCount(terms[t]);
+            if (count < driverCount) {
+                driverTerm = t;
+                driverCount = count;
+            }
+        }
+        if (driverCount == 0) return hits;
+        vector<int> driver = candidates(terms[driverTerm]);
+        vector<string> whole, prefix;
+        for (const string& term : terms) {
+            whole.push_back(" " + term + " ");
+            prefix.push_back(" " + term);
+        }
+        // (score, document) until the best are known; the text is copied only for those
+        vector<pair<int, int>> scored;
+        for (int doc : driver) {
+            const Document& d = documents[doc];
+            if (!d.live || ((int)only != 0 && d.table != only)) continue;
+            int score = 0;
+            for (size_t t = 0; t < terms.size(); ++t) {
+                if (d.folded.find(whole[t]) != string::npos) score += 3;
+                else if (d.folded.find(prefix[t]) != string::npos) score += 2;
+                else if (terms[t].size() >= 3 && d.folded.find(terms[t]) != string::npos) score += 1;
+                else {
+                    score = 0;
+                    break;
+                }
+            }
+            if (score > 0) scored.push_back({ score, doc });
+        }
+        auto better = [this](const pair<int, int>& a, const pair<int, int>& b) {
+            if (a.first != b.first) return a.first > b.first;
+            const Document& x = documents[a.second];
+            const Document& y = documents[b.second];
+            if (x.text.size() != y.text.size()) return x.text.size() < y.text.size();
+            if (x.table != y.table) return x.table < y.table;
+            return x.id < y.id;
+        };
+        if (scored.size() > limit) {
+            partial_sort(scored.begin(), scored.begin() + limit, scored.end(), better);
+            scored.resize(limit);
+        }
+        else sort(scored.begin(), scored.end(), better);
+        for (const auto& s : scored) {
+            const Document& d = documents[s.second];
+            hits.push_back(Hit{ d.table, d.id, s.first, d.text });
+        }
+        return hits;
+    }
+};
+
+// history page cache
+
+// One fixed-size page of an archive file, decoded. A page holds either sessions (in date order)
+// or makeup requests.
+struct HistoryPage {
+    vector<ScheduleEntry> sessions;
+    vector<MakeupRequest> requests;
+
+    size_t memoryBytes() const {
+        size_t bytes = sizeof(HistoryPage) + sessions.capacity() * sizeof(ScheduleEntry) + requests.capacity() * sizeof(MakeupRequest);
+        for (const auto& mr : requests) bytes += mr.reason.capacity();
+        return bytes;
+    }
+};
+
+// LRU buffer pool for history pages under a memory budget. Misses call the loader on the
+// requesting thread; prefetch() queues a load on a background I/O thread so a sequential scan
+// finds its next pages ready. Pages are handed out as shared_ptr, so an evicted page stays valid
+// for a scan still using it; resident memory is the budget plus the pages in flight.
+class PageCache {
+public:
+    typedef uint64_t Key;
+    typedef function<shared_ptr<HistoryPage>(Key)> Loader;
+
+private:
+    struct Slot {
+        shared_ptr<const HistoryPage> page;
+        size_t bytes = 0;
+        bool loading = true;
+        list<Key>::iterator lru;
+    };
+
+    Loader loader;
+    size_t budget;
+    size_t used = 0;
+    unordered_map<Key, Slot> slots;
+    list<Key> lru; // most recently used first; loading slots are not in it
+    mutex lock;
+    condition_variable loaded;
+    deque<Key> queue;
+    condition_variable queued;
+    thread io;
+    bool stopping = false;
+
+    // called with the lock held once a load finishes; a failed load leaves no slot behind
+    void finish(Key key, shared_ptr<HistoryPage> page) {
+        if (!page) {
+            slots.erase(key);
+        }
+        else {
+            Slot& slot = slots[key];
+            slot.page = page;
+            slot.bytes = page->memoryBytes();
+            slot.loading = false;
+            lru.push_front(key);
+            slot.lru = lru.begin();
+            used += slot.bytes;
+            while (used > budget && lru.size() > 1) {
+                Key victim = lru.back();
+                lru.pop_back();
+                used -= slots[victim].bytes;
+                slots.erase(victim);
+                SystemStats::instance().historyPageEvictions.fetch_add(1, memory_order_relaxed);
+            }
+        }
+        loaded.notify_all();
+    }
+
+    void ioLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            queued.wait(guard, [&] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            Key key = queue.front();
+            queue.pop_front();
+            if (slots.count(key)) continue;
+            slots[key].loading = true;
+            guard.unlock();
+            shared_ptr<HistoryPage> page = loader(key);
+            guard.lock();
+            finish(key, page);
+        }
+    }
+
+public:
+    PageCache(Loader load, size_t budgetBytes) : loader(load), budget(budgetBytes) {}
+
+    ~PageCache() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        queued.notify_all();
+        if (io.joinable()) io.join();
+    }
+
+    // nullptr if the page could not be read
+    shared_ptr<const HistoryPage> get(Key key) {
+        SystemStats& stats = SystemStats::instance();
+        unique_lock<mutex> guard(lock);
+        auto it = slots.find(key);
+        if (it != slots.end()) {
+            loaded.wait(guard, [&] { it = slots.find(key); return it == slots.end() || !it->second.loading; });
+            if (it != slots.end()) {
+                stats.historyPageHits.fetch_add(1, memory_order_relaxed);
+                lru.splice(lru.begin(), lru, it->second.lru);
+                return it->second.page;
+            }
+        }
+        stats.historyPageMisses.fetch_add(1, memory_order_relaxed);
+        slots[key].loading = true;
+        guard.unlock();
+        shared_ptr<HistoryPage> page = loader(key);
+        guard.lock();
+        finish(key, page);
+        return page;
+    }
+
+    void prefetch(Key key) {
+        lock_guard<mutex> guard(lock);
+        if (slots.count(key) || find(queue.begin(), queue.end(), key) != queue.end()) return;
+        if (!io.joinable()) io = thread(&PageCache::ioLoop, this);
+        queue.push_back(key);
+        SystemStats::instance().historyPrefetches.fetch_add(1, memory_order_relaxed);
+        queued.notify_one();
+    }
+
+    // drops every resident page, e.g. after archive files were rewritten
+    void clear() {
+        unique_lock<mutex> guard(lock);
+        queue.clear();
+        loaded.wait(guard, [&] {
+            for (const auto& s : slots) if (s.second.loading) return false;
+            return true;
+        });
+        slots.clear();
+        lru.clear();
+        used = 0;
+    }
+
+    void setBudget(size_t bytes) {
+        lock_guard<mutex> guard(lock);
+        budget = bytes;
+    }
+    size_t budgetBytes() const { return budget; }
+    size_t residentBytes() {
+        lock_guard<mutex> guard(lock);
+        return used;
+    }
+};
+
+
+class DataManager {
+private:
+
+    static int nextPersonId;
+    static int nextLabSectionId;
+    static int nextRoomId;
+    static int nextScheduleId;
+    static int nextMakeupId;
+    static int nextBuildingId;
+    static int nextHolidayId;
+    static int nextCourseId;
+
+    shared_ptr<StorageEngine> storage;
+
+    // file names within storage
+    const string PERSONS_FILE = "persons.dat";
+    const string LABS_FILE = "labs.dat";
+    const string ROOMS_FILE = "rooms.dat";
+    const string SCHEDULES_FILE = "schedules.dat";
+    const string MAKEUP_FILE = "makeup_requests.dat";
+    const string BUILDINGS_FILE = "buildings.dat";
+    const string HOLIDAYS_FILE = "holidays.dat";
+    const string COURSES_FILE = "courses.dat";
+
+    // every file starts with "LMS" and a format version byte (RecordSchema<T>::FORMAT);
+    // files from before the header are version 0
+
+    // batch mode: saves only mark the file dirty, commitBatch() writes each one once
+    bool batchMode = false;
+    set<string> dirtyFiles;
+
+    // every mutation is also appended to the change log, after the data file it touched has been
+    // written (in batch mode, after commitBatch has written them all)
+    ChangeLog changes;
+    bool captureChanges = true;
+
+    // Data versions for caches of derived results (the HoD report cache). Each change to a table
+    // advances its version from one clock; a schedule change also advances its section's version.
+    // Sections untouched since the last load or archive run report sectionBaseVersion.
+    uint64_t versionClock = 0;
+    uint64_t tableVersions[(int)ChangeTable::Holiday + 1] = {};
+    unordered_map<int, uint64_t> sectionVersions;
+    uint64_t sectionBaseVersion = 0;
+    uint64_t archiveStamp = 0; // advanced when the archive tier is loaded or written
+
+    void touch(ChangeTable table) { tableVersions[(int)table] = ++versionClock; }
+
+    template <typename T>
+    void touchSection(const T&) {}
+    void touchSection(const ScheduleEntry& se) { sectionVersions[se.sectionId] = ++versionClock; }
+
+    // every section at once, after a load or an archive run rewrote the schedule store
+    void touchAllSections() {
+        sectionVersions.clear();
+        sectionBaseVersion = ++versionClock;
+    }
+
+    // type-ahead search over names, kept in step with the tables
+    SearchIndex searchIndex;
+
+    template <typename T>
+    void indexForSearch(const T&) {}
+    void indexForSearch(const Person& p) { searchIndex.add(ChangeTable::Person, p.personId, p.name.str()); }
+    void indexForSearch(const Building& b) { searchIndex.add(ChangeTable::Building, b.buildingId, b.name.str()); }
+    void indexForSearch(const Room& r) { searchIndex.add(ChangeTable::Room, r.roomId, r.roomName.str()); }
+    void indexForSearch(const Course& c) { searchIndex.add(ChangeTable::Course, c.courseId, c.courseCode + " " + c.courseName); }
+
+    void rebuildSearchIndex() {
+        TraceSpan span("rebuildSearchIndex");
+        searchIndex.clear();
+        for (const auto& p : persons) indexForSearch(p);
+        for (const auto& b : buildings) indexForSearch(b);
+        for (const auto& r : rooms) indexForSearch(r);
+        for (const auto& c : courses) indexForSearch(c);
+    }
+
+    // queues the change for changes.log; a mutator that changes several records queues each one
+    // and flushes once
+    template <typename T>
+    void queueChange(ChangeTable table, ChangeKind kind, int id, const T& record) {
+        touch(table);
+        touchSection(record);
+        indexForSearch(record);
+        if (!captureChanges) return;
+        ByteWriter out;
+        writeRecord(out, record);
+        changes.add(table, kind, (uint8_t)formatVersion<T>(), id, out.bytes);
+    }
+
+    template <typename T>
+    void recordChange(ChangeTable table, ChangeKind kind, int id, const T& record) {
+        queueChange(table, kind, id, record);
+        if (!batchMode) changes.flush();
+    }
+
+    // date key (YYYYMMDD) -> positions in schedules, kept in step with schedules
+    map<int, vector<int>> scheduleDateIndex;
+    // scheduleId -> position in schedules
+    unordered_map<int, int> scheduleIdIndex;
+    // sectionId / roomId -> positions in schedules, for ScheduleQuery plans
+    unordered_map<int, vector<int>> scheduleSectionIndex;
+    unordered_map<int, vector<int>> scheduleRoomIndex;
+    // roomId -> position in rooms, which is also the room's column in the occupancy bitmaps
+    unordered_map<int, int> roomPositions;
+    OccupancyIndex occupancy;       // expected times of sessions that are not canceled
+    OccupancyIndex actualOccupancy; // actual times from filled timesheets
+    // courseId -> position in courses, course code -> courseId
+    unordered_map<int, int> coursePositions;
+    // id -> position for the tables without an index of their own, used by applyChange
+    unordered_map<int, int> applyPositions[(int)ChangeTable::Holiday + 1];
+    unordered_map<string, int> courseCodeIndex;
+
+    // archive tier: closed semesters live in read-only archive-<semester>.dat files, listed in
+    // archive.dat. Reports stream them a page at a time through historyCache, so memory stays
+    // within the cache budget however many years of history there are.
+    const string ARCHIVE_INDEX_FILE = "archive.dat";
+    static const int ARCHIVE_FORMAT = 2;
+    static const size_t PAGE_SIZE = 16384;
+    static const size_t MAX_ARCHIVED_REASON = 4096; // longer reasons are cut so a request fits a page
+    static const int READ_AHEAD = 2;                // pages a scan asks the cache to load ahead of it
+    enum PageKind : unsigned char { SESSION_PAGE = 1, REQUEST_PAGE = 2 };
+    vector<ArchivedSemester> archivedSemesters; // ascending by semester
+    mutable PageCache historyCache;
+
+    void rebuildCourseIndexes() {
+        coursePositions.clear();
+        courseCodeIndex.clear();
+        for (size_t i = 0; i < courses.size(); ++i) {
+            coursePositions[courses[i].courseId] = (int)i;
+            courseCodeIndex[courses[i].courseCode] = courses[i].courseId;
+        }
+    }
+
+    // marks one session of store in the expected/actual bitmaps
+    void markSession(const ScheduleStore& store, size_t pos, OccupancyIndex& expected, OccupancyIndex& actual) const {
+        if (store.isCanceled(pos)) return;
+        auto room = roomPositions.find(store.roomId(pos));
+        if (room == roomPositions.end()) return;
+        int start = store.startMinute(pos), end = store.endMinute(pos);
+        expected.mark(store.dateKey(pos), room->second, Time(start / 60, start % 60), Time(end / 60, end % 60));
+        if (store.status(pos) == 1) {
+            actual.mark(store.dateKey(pos), room->second, store.actualStart(pos), store.actualEnd(pos));
+        }
+    }
+
+    void markOccupied(size_t pos) { markSession(schedules, pos, occupancy, actualOccupancy); }
+
+    // the same for an archived session
+    void markSession(const ScheduleEntry& se, OccupancyIndex& expected, OccupancyIndex& actual) const {
+        if (se.isCanceled) return;
+        auto room = roomPositions.find(se.roomId);
+        if (room == roomPositions.end()) return;
+        expected.mark(se.scheduledDate.toKey(), room->second, se.expectedStart, se.expectedEnd);
+        if (se.status == 1) actual.mark(se.scheduledDate.toKey(), room->second, se.actualStart, se.actualEnd);
+    }
+
+    // recomputes one room's bitmap for one day from the sessions still standing
+    void refreshOccupancy(int dayKey, int roomId) {
+        auto room = roomPositions.find(roomId);
+        if (room == roomPositions.end()) return;
+        occupancy.clearRoomDay(dayKey, room->second);
+        actualOccupancy.clearRoomDay(dayKey, room->second);
+        auto day = scheduleDateIndex.find(dayKey);
+        if (day == scheduleDateIndex.end()) return;
+        for (int pos : day->second) {
+            if (schedules.roomId(pos) == roomId) markOccupied(pos);
+        }
+    }
+
+    void rebuildOccupancy() {
+        TraceSpan span("rebuildOccupancy");
+        roomPositions.clear();
+        for (size_t i = 0; i < rooms.size(); ++i) roomPositions[rooms[i].roomId] = (int)i;
+        occupancy.reset(rooms.size());
+        actualOccupancy.reset(rooms.size());
+        for (size_t i = 0; i < schedules.size(); ++i) markOccupied(i);
+    }
+
+    // adds / removes position pos in the date, section and room indexes
+    void indexSchedule(int pos) {
+        scheduleDateIndex[schedules.dateKey(pos)].push_back(pos);
+        scheduleSectionIndex[schedules.sectionId(pos)].push_back(pos);
+        scheduleRoomIndex[schedules.roomId(pos)].push_back(pos);
+    }
+
+    void unindexSchedule(int pos) {
+        vector<int>* lists[] = { &scheduleDateIndex[schedules.dateKey(pos)],
+            &scheduleSectionIndex[schedules.sectionId(pos)], &scheduleRoomIndex[schedules.roomId(pos)] };
+        for (vector<int>* list : lists) list->erase(find(list->begin(), list->end(), pos));
+    }
+
+    void rebuildScheduleIndexes() {
+        TraceSpan span("rebuildScheduleIndexes");
+        scheduleDateIndex.clear();
+        scheduleIdIndex.clear();
+        scheduleSectionIndex.clear();
+        scheduleRoomIndex.clear();
+        for (size_t i = 0; i < schedules.size(); ++i) {
+            indexSchedule((int)i);
+            scheduleIdIndex[schedules.scheduleId(i)] = (int)i;
+        }
+        rebuildOccupancy();
+    }
+
+
+    static void writeHeader(ByteWriter& out, int version) {
+        out.put("LMS", 3);
+        out.bytes.push_back((char)version);
+    }
+
+    // reads the header if present; otherwise leaves the cursor alone and reports version 0
+    static int readHeader(ByteReader& in) {
+        if (in.remaining() >= 4 && memcmp(in.pos, "LMS", 3) == 0) {
+            int version = (unsigned char)in.pos[3];
+            in.pos += 4;
+            return version;
+        }
+        return 0;
+    }
+
+    // -1 when the file is missing or empty
+    int fileVersion(const std::string& filename) {
+        char head[4] = { 0 };
+        size_t n = storage->readAt(filename, 0, head, sizeof(head));
+        if (n == 0) return -1;
+        ByteReader in(head, head + n);
+        return readHeader(in);
+    }
+
+    // whole file into bytes; false if it cannot be opened
+    bool readFile(const std::string& filename, string& bytes) const { return storage->read(filename, bytes); }
+
+    template <typename T>
+    static int formatVersion() { return RecordSchema<T>::FORMAT; }
+
+    template <typename T>
+    void writeRecord(ByteWriter& out, const T& record) {
+        static_assert(RecordSchema<T>::layout() == RecordSchema<T>::LAYOUT,
+            "stored fields changed: bump FORMAT, keep a readLegacy for the old one, then update LAYOUT");
+        RecordSchema<T>::write(out, record);
+    }
+
+    // records in the current format come straight from the schema, older ones from readLegacy
+    template <typename T>
+    bool readRecord(ByteReader& in, T& record, int version) {
+        if (version == RecordSchema<T>::FORMAT) return RecordSchema<T>::read(in, record);
+        return readLegacy(in, record, version);
+    }
+
+    // older formats; false when there is no reader for the version
+    template <typename T>
+    bool readLegacy(ByteReader&, T&, int) { return false; }
+
+    // the old writers stored ints in 8-byte slots; only the low 4 bytes are meaningful
+    bool readIdSlot(ByteReader& in, int& id) {
+        long long slot = 0;
+        if (!in.get(slot)) return false;
+        id = (int)(slot & 0xffffffff);
+        return true;
+    }
+
+    bool readLegacy(ByteReader& in, Person& p, int version) {
+        if (version != 0) return false;
+        string role;
+        bool ok = readIdSlot(in, p.personId) && FieldCodec<IString>::read(in, p.name)
+            && FieldCodec<string>::read(in, role) && FieldCodec<IString>::read(in, p.password);
+        p.role = parseRole(role);
+        return ok;
+    }
+
+    bool readLegacy(ByteReader& in, Building& b, int version) {
+        if (version != 0) return false;
+        return readIdSlot(in, b.buildingId) && FieldCodec<IString>::read(in, b.name)
+            && FieldCodec<string>::read(in, b.address) && readIdSlot(in, b.attendantId);
+    }
+
+    bool readLegacy(ByteReader& in, Room& r, int version) {
+        if (version != 0) return false;
+        return readIdSlot(in, r.roomId) && FieldCodec<IString>::read(in, r.roomName) && readIdSlot(in, r.buildingId);
+    }
+
+    // older files wrote the TA list like a vector (size_t count); anything past the capacity is dropped
+    bool readLegacyIdList(ByteReader& in, SmallVector<int, LabSection::MAX_TAS>& ids) {
+        size_t n = 0;
+        if (!in.get(n)) return false;
+        ids.clear();
+        for (size_t i = 0; i < n; ++i) {
+            int id = 0;
+            if (!in.get(id)) return false;
+            ids.push_back(id);
+        }
+        return true;
+    }
+
+    bool readLegacy(ByteReader& in, LabSection& ls, int version) {
+        if (version != 1) return false;
+        return in.get(ls.courseId) && in.get(ls.sectionId) && FieldCodec<IString>::read(in, ls.sectionName)
+            && in.get(ls.instructorId) && readLegacyIdList(in, ls.taIds);
+    }
+
+    // format 0 was the struct as laid out in memory: 3 ints, Date, 4 Times, 2 bools, 2 bytes padding, int
+    bool readLegacy(ByteReader& in, ScheduleEntry& se, int version) {
+        if (version != 0) return false;
+        return in.get(se.scheduleId) && in.get(se.sectionId) && in.get(se.roomId) && in.get(se.scheduledDate)
+            && in.get(se.expectedStart) && in.get(se.expectedEnd) && in.get(se.actualStart) && in.get(se.actualEnd)
+            && in.get(se.isMakeup) && in.get(se.isCanceled) && in.take(2) && in.get(se.status);
+    }
+
+    bool readLegacy(ByteReader& in, MakeupRequest& mr, int version) {
+        if (version != 0) return false;
+        return readIdSlot(in, mr.requestId) && readIdSlot(in, mr.sectionId) && readIdSlot(in, mr.instructorId)
+            && in.get(mr.requestedDate) && in.get(mr.requestedStart) && in.get(mr.requestedEnd)
+            && FieldCodec<string>::read(in, mr.reason) && in.get(mr.status);
+    }
+
+    bool readLegacy(ByteReader& in, Holiday& h, int version) {
+        return version == 0 && RecordSchema<Holiday>::read(in, h);
+    }
+
+    // the page counts stay 0 until migrateArchives rewrites the semester's file
+    bool readLegacy(ByteReader& in, ArchivedSemester& a, int version) {
+        return version == 1 && in.get(a.semester) && in.get(a.scheduleCount) && in.get(a.requestCount)
+            && in.get(a.maxScheduleId) && in.get(a.maxRequestId) && in.get(a.fileBytes);
+    }
+
+    // Rewrites archive files still in format 1 as pages. The file version is checked rather
+    // than the index, so an interrupted migration picks up where it stopped.
+    void migrateArchives() {
+        bool changed = false;
+        for (auto& a : archivedSemesters) {
+            if (fileVersion(archiveFile(a.semester)) != 1) continue;
+            TraceSpan span("migrateArchive");
+            vector<ScheduleEntry> sessions;
+            vector<MakeupRequest> reqs;
+            if (!readArchive(a.semester, sessions, reqs) || !writeArchive(a, sessions, reqs)) continue;
+            changed = true;
+        }
+        if (changed) saveAllRecords(ARCHIVE_INDEX_FILE, archivedSemesters);
+    }
+
+    // format 0 labs.dat: every section carried its own course code and name
+    bool readLegacyLab(ByteReader& in, Course& c, LabSection& ls) {
+        int courseId = 0;
+        bool ok = readIdSlot(in, courseId) && FieldCodec<IString>::read(in, c.courseCode)
+            && FieldCodec<IString>::read(in, c.courseName) && readIdSlot(in, ls.sectionId)
+            && FieldCodec<IString>::read(in, ls.sectionName) && readIdSlot(in, ls.instructorId)
+            && readLegacyIdList(in, ls.taIds);
+        c.courseId = ls.courseId = courseId;
+        return ok;
+    }
+
+    // Splits a format 0 labs.dat into courses.dat + labs.dat. The old file is kept as labs.dat.v0.
+    bool migrateLegacyLabs() {
+        TraceSpan span("migrateLegacyLabs");
+        string bytes;
+        if (!readFile(LABS_FILE, bytes)) return false;
+        ByteReader in(bytes.data(), bytes.data() + bytes.size());
+        vector<Course> legacyCourses;
+        vector<LabSection> legacySections;
+        set<int> seen;
+        while (!in.atEnd()) {
+            Course c;
+            LabSection ls;
+            if (!readLegacyLab(in, c, ls)) break;
+            if (seen.insert(c.courseId).second) legacyCourses.push_back(c);
+            legacySections.push_back(ls);
+        }
+
+        if (!storage->rename(LABS_FILE, LABS_FILE + ".v0")) {
+            cout << "[ERROR] Could not back up " << LABS_FILE << " before migrating it." << endl;
+            return false;
+        }
+        bool ok = saveAllRecords(COURSES_FILE, legacyCourses) && saveAllRecords(LABS_FILE, legacySections);
+        cout << "Migrated " << LABS_FILE << ": " << legacyCourses.size() << " courses, " << legacySections.size()
+            << " sections (old file kept as " << LABS_FILE << ".v0)." << endl;
+        return ok;
+    }
+
+    // Appends every record in filename to records (a vector or SlabStore). The file is read in one go.
+    // Returns the file's format version, or -1 if the file could not be opened or read to the end.
+    template <typename Store>
+    int readAllRecords(const std::string& filename, Store& records) {
+        typedef typename Store::value_type T;
+        TraceSpan span("load", filename.c_str());
+        SystemStats& stats = SystemStats::instance();
+        ScopedTimer timer(stats.operation("load " + filename));
+        string bytes;
+        if (!readFile(filename, bytes)) return -1;
+        SystemStats::FileCounters& counters = stats.file(filename);
+        counters.bytesRead += bytes.size();
+        counters.loads++;
+
+        ByteReader in(bytes.data(), bytes.data() + bytes.size());
+        int version = readHeader(in);
+        if (version > formatVersion<T>()) {
+            cout << "[ERROR] " << filename << " was written by a newer version (format " << version << ")." << endl;
+            return version;
+        }
+        size_t count = 0;
+        while (!in.atEnd()) {
+            T record;
+            if (!readRecord(in, record, version)) {
+                cout << "[ERROR] " << filename << " could not be read past record " << count << "." << endl;
+                return -1;
+            }
+            records.push_back(record);
+            count++;
+        }
+        return version;
+    }
+
+    // reads filename into records; a file in an older format is rewritten in the current one
+    template <typename Store>
+    void loadTable(const std::string& filename, Store& records) {
+        int version = readAllRecords(filename, records);
+        if (version >= 0 && version < formatVersion<typename Store::value_type>()) saveAllRecords(filename, records);
+    }
+
+    string archiveFile(int semester) const { return "archive-" + ArchivedSemester::name(semester) + ".dat"; }
+
+    static int minutesOf(const Time& t) { return t.getHour() * 60 + t.getMinute(); }
+    static Time timeOf(long long minutes) { return Time((int)(minutes / 60), (int)(minutes % 60)); }
+    static Date dateOf(long long dayNumber, int weekday) {
+        Date d = Date::fromDayNumber((int)dayNumber);
+        d.setDate(d.getDay(), d.getMonth(), d.getYear(), weekday); // keep the stored weekday as it was
+        return d;
+    }
+
+    // Archive files are written once per semester and only read afterwards, so they trade
+    // update-in-place for size: ids and day numbers are varint deltas from the previous record,
+    // flags and weekday share one byte, and times are minutes. A session takes about 10 bytes.
+    // The deltas restart at every page so each page decodes on its own.
+    struct ArchiveCursor {
+        long long id = 0, section = 0, other = 0, day = 0; // other: room of a session, instructor of a request
+    };
+
+    static void encodeSession(ByteWriter& out, const ScheduleEntry& se, ArchiveCursor& prev) {
+        long long day = se.scheduledDate.toDayNumber();
+        int start = minutesOf(se.expectedStart), end = minutesOf(se.expectedEnd);
+        int actualStart = minutesOf(se.actualStart), actualEnd = minutesOf(se.actualEnd);
+        bool hasActual = actualStart != 0 || actualEnd != 0;
+        putVarint(out, zigzag(se.scheduleId - prev.id));
+        putVarint(out, zigzag(se.sectionId - prev.section));
+        putVarint(out, zigzag(se.roomId - prev.other));
+        putVarint(out, zigzag(day - prev.day));
+        out.bytes.push_back((char)((se.isMakeup ? 1 : 0) | (se.isCanceled ? 2 : 0) | (hasActual ? 4 : 0)
+            | (se.status & 3) << 3 | se.scheduledDate.getWeekday() << 5));
+        putVarint(out, start);
+        putVarint(out, zigzag(end - start));
+        if (hasActual) {
+            putVarint(out, actualStart);
+            putVarint(out, zigzag(actualEnd - actualStart));
+        }
+        prev.id = se.scheduleId; prev.section = se.sectionId; prev.other = se.roomId; prev.day = day;
+    }
+
+    static bool decodeSession(ByteReader& in, ScheduleEntry& se, ArchiveCursor& prev) {
+        unsigned char flags = 0;
+        uint64_t v = 0, start = 0, length = 0;
+        if (!in.getVarint(v)) return false;
+        se.scheduleId = (int)(prev.id += unzigzag(v));
+        if (!in.getVarint(v)) return false;
+        se.sectionId = (int)(prev.section += unzigzag(v));
+        if (!in.getVarint(v)) return false;
+        se.roomId = (int)(prev.other += unzigzag(v));
+        if (!in.getVarint(v) || !in.get(flags) || !in.getVarint(start) || !in.getVarint(length)) return false;
+        prev.day += unzigzag(v);
+        se.scheduledDate = dateOf(prev.day, flags >> 5);
+        se.isMakeup = (flags & 1) != 0;
+        se.isCanceled = (flags & 2) != 0;
+        se.status = (flags >> 3) & 3;
+        se.expectedStart = timeOf((long long)start);
+        se.expectedEnd = timeOf((long long)start + unzigzag(length));
+        if (flags & 4) {
+            if (!in.getVarint(start) || !in.getVarint(length)) return false;
+            se.actualStart = timeOf((long long)start);
+            se.actualEnd = timeOf((long long)start + unzigzag(length));
+        }
+        return true;
+    }
+
+    static void encodeRequest(ByteWriter& out, const MakeupRequest& mr, ArchiveCursor& prev) {
+        long long day = mr.requestedDate.toDayNumber();
+        int start = minutesOf(mr.requestedStart), end = minutesOf(mr.requestedEnd);
+        size_t reasonLength = mr.reason.size() < MAX_ARCHIVED_REASON ? mr.reason.size() : MAX_ARCHIVED_REASON;
+        putVarint(out, zigzag(mr.requestId - prev.id));
+        putVarint(out, zigzag(mr.sectionId - prev.section));
+        putVarint(out, zigzag(mr.instructorId - prev.other));
+        putVarint(out, zigzag(day - prev.day));
+        out.bytes.push_back((char)((mr.status & 3) | mr.requestedDate.getWeekday() << 2));
+        putVarint(out, start);
+        putVarint(out, zigzag(end - start));
+        putVarint(out, reasonLength);
+        out.put(mr.reason.data(), reasonLength);
+        prev.id = mr.requestId; prev.section = mr.sectionId; prev.other = mr.instructorId; prev.day = day;
+    }
+
+    static bool decodeRequest(ByteReader& in, MakeupRequest& mr, ArchiveCursor& prev) {
+        unsigned char flags = 0;
+        uint64_t v = 0, start = 0, length = 0, reasonLength = 0;
+        if (!in.getVarint(v)) return false;
+        mr.requestId = (int)(prev.id += unzigzag(v));
+        if (!in.getVarint(v)) return false;
+        mr.sectionId = (int)(prev.section += unzigzag(v));
+        if (!in.getVarint(v)) return false;
+        mr.instructorId = (int)(prev.other += unzigzag(v));
+        if (!in.getVarint(v) || !in.get(flags) || !in.getVarint(start) || !in.getVarint(length)) return false;
+        prev.day += unzigzag(v);
+        mr.requestedDate = dateOf(prev.day, flags >> 2);
+        mr.status = flags & 3;
+        mr.requestedStart = timeOf((long long)start);
+        mr.requestedEnd = timeOf((long long)start + unzigzag(length));
+        if (!in.getVarint(reasonLength)) return false;
+        const char* reason = in.take((size_t)reasonLength);
+        if (!reason) return false;
+        mr.reason.assign(reason, (size_t)reasonLength);
+        return true;
+    }
+
+    // Packs records into PAGE_SIZE pages: a kind byte, a uint16 record count, the records, then
+    // zero padding. Returns the number of pages written.
+    template <typename Record, typename Encode>
+    static int encodePages(ByteWriter& out, PageKind kind, const vector<Record>& records, Encode encode) {
+        int pages = 0;
+        size_t pageStart = 0;
+        uint16_t count = 0;
+        ArchiveCursor prev;
+        ByteWriter record;
+        auto closePage = [&] {
+            memcpy(&out.bytes[pageStart + 1], &count, sizeof(count));
+            out.bytes.resize(pageStart + PAGE_SIZE, '\0');
+        };
+        for (const auto& r : records) {
+            record.bytes.clear();
+            ArchiveCursor next = prev;
+            encode(record, r, next);
+            if (pages == 0 || out.bytes.size() + record.bytes.size() > pageStart + PAGE_SIZE || count == UINT16_MAX) {
+                if (pages > 0) closePage();
+                pageStart = out.bytes.size();
+                out.bytes.push_back((char)kind);
+                out.bytes.append(sizeof(count), '\0');
+                pages++;
+                count = 0;
+                next = ArchiveCursor();
+                record.bytes.clear();
+                encode(record, r, next);
+            }
+            out.put(record.bytes.data(), record.bytes.size());
+            prev = next;
+            count++;
+        }
+        if (pages > 0) closePage();
+        return pages;
+    }
+
+    // Format 2: the header, then the session pages in (date, id) order, then the request pages.
+    // Sorting by date lets a scan close off the days before each page it has read.
+    static void encodeArchive(ByteWriter& out, vector<ScheduleEntry>& sessions, vector<MakeupRequest>& reqs, ArchivedSemester& info) {
+        sort(sessions.begin(), sessions.end(), [](const ScheduleEntry& a, const ScheduleEntry& b) {
+            int ka = a.scheduledDate.toKey(), kb = b.scheduledDate.toKey();
+            return ka != kb ? ka < kb : a.scheduleId < b.scheduleId;
+        });
+        sort(reqs.begin(), reqs.end(), [](const MakeupRequest& a, const MakeupRequest& b) {
+            int ka = a.requestedDate.toKey(), kb = b.requestedDate.toKey();
+            return ka != kb ? ka < kb : a.requestId < b.requestId;
+        });
+        writeHeader(out, ARCHIVE_FORMAT);
+        info.schedulePages = encodePages(out, SESSION_PAGE, sessions, encodeSession);
+        info.requestPages = encodePages(out, REQUEST_PAGE, reqs, encodeRequest);
+    }
+
+    // one page's records; false if the page is damaged
+    static bool decodePage(const char* bytes, size_t size, HistoryPage& page) {
+        ByteReader in(bytes, bytes + size);
+        unsigned char kind = 0;
+        uint16_t count = 0;
+        if (!in.get(kind) || !in.get(count)) return false;
+        ArchiveCursor prev;
+        if (kind == SESSION_PAGE) {
+            page.sessions.resize(count);
+            for (auto& se : page.sessions) if (!decodeSession(in, se, prev)) return false;
+        }
+        else if (kind == REQUEST_PAGE) {
+            page.requests.resize(count);
+            for (auto& mr : page.requests) if (!decodeRequest(in, mr, prev)) return false;
+        }
+        else return false;
+        return true;
+    }
+
+    // Format 1 files held one delta-encoded run of all sessions, then of all requests, after a
+    // varint semester and counts; they are rewritten in pages when the data is loaded.
+    static bool decodeArchiveV1(ByteReader& in, vector<ScheduleEntry>& sessions, vector<MakeupRequest>& reqs) {
+        uint64_t semester = 0, sessionCount = 0, requestCount = 0;
+        if (readHeader(in) != 1) return false;
+        if (!in.getVarint(semester) || !in.getVarint(sessionCount) || !in.getVarint(requestCount)) return false;
+        ArchiveCursor prev;
+        for (uint64_t i = 0; i < sessionCount; ++i) {
+            ScheduleEntry se;
+            if (!decodeSession(in, se, prev)) return false;
+            sessions.push_back(se);
+        }
+        prev = ArchiveCursor();
+        for (uint64_t i = 0; i < requestCount; ++i) {
+            MakeupRequest mr;
+            if (!decodeRequest(in, mr, prev)) return false;
+            reqs.push_back(mr);
+        }
+        return true;
+    }
+
+    // every record of one archived semester, bypassing the cache (merging, migration)
+    bool readArchive(int semester, vector<ScheduleEntry>& sessions, vector<MakeupRequest>& reqs) const {
+        string file = archiveFile(semester);
+        string bytes;
+        if (!readFile(file, bytes)) {
+            cout << "[ERROR] Archive " << file << " is missing." << endl;
+            return false;
+        }
+        SystemStats::FileCounters& counters = SystemStats::instance().file(file);
+        counters.bytesRead += bytes.size();
+        counters.loads++;
+        ByteReader in(bytes.data(), bytes.data() + bytes.size());
+        int version = readHeader(in);
+        bool ok = version == 1;
+        if (ok) {
+            in = ByteReader(bytes.data(), bytes.data() + bytes.size());
+            ok = decodeArchiveV1(in, sessions, reqs);
+        }
+        else if (version == ARCHIVE_FORMAT) {
+            ok = true;
+            for (size_t at = 4; ok && at + PAGE_SIZE <= bytes.size(); at += PAGE_SIZE) {
+                HistoryPage page;
+                ok = decodePage(bytes.data() + at, PAGE_SIZE, page);
+                sessions.insert(sessions.end(), page.sessions.begin(), page.sessions.end());
+                reqs.insert(reqs.end(), page.requests.begin(), page.requests.end());
+            }
+        }
+        if (!ok) cout << "[ERROR] Archive " << file << " could not be read." << endl;
+        return ok;
+    }
+
+    // writes one semester's archive file and fills in its index entry; false on a write error
+    bool writeArchive(ArchivedSemester& info, vector<ScheduleEntry>& sessions, vector<MakeupRequest>& reqs) {
+        ByteWriter out;
+        encodeArchive(out, sessions, reqs, info);
+        string file = archiveFile(info.semester);
+        // written aside and renamed into place, like saveAllRecords
+        if (!storage->write(file + ".tmp", out.bytes.data(), out.bytes.size()) || !storage->rename(file + ".tmp", file)) {
+            cout << "[ERROR] Could not write " << file << endl;
+            return false;
+        }
+        SystemStats::instance().file(file).bytesWritten += out.bytes.size();
+        info.scheduleCount = (int)sessions.size();
+        info.requestCount = (int)reqs.size();
+        info.fileBytes = (int)out.bytes.size();
+        info.maxScheduleId = info.maxRequestId = 0;
+        for (const auto& se : sessions) info.maxScheduleId = max(info.maxScheduleId, se.scheduleId);
+        for (const auto& mr : reqs) info.maxRequestId = max(info.maxRequestId, mr.requestId);
+        return true;
+    }
+
+    static PageCache::Key pageKey(int semester, int page) { return (PageCache::Key)semester << 32 | (uint32_t)page; }
+
+    // PageCache loader: one page read straight from its offset in the semester's file
+    shared_ptr<HistoryPage> loadPage(PageCache::Key key) const {
+        string file = archiveFile((int)(key >> 32));
+        TraceSpan span("loadPage", file.c_str());
+        string bytes(PAGE_SIZE, '\0');
+        if (storage->readAt(file, 4 + (size_t)(uint32_t)key * PAGE_SIZE, &bytes[0], PAGE_SIZE) != PAGE_SIZE) {
+            cout << "[ERROR] Archive " << file << " is missing page " << (uint32_t)key << "." << endl;
+            return nullptr;
+        }
+        SystemStats::instance().file(file).bytesRead += PAGE_SIZE;
+        shared_ptr<HistoryPage> page = make_shared<HistoryPage>();
+        if (!decodePage(bytes.data(), bytes.size(), *page)) {
+            cout << "[ERROR] Archive " << file << " page " << (uint32_t)key << " could not be read." << endl;
+            return nullptr;
+        }
+        return page;
+    }
+
+    // LMS_HISTORY_CACHE_MB, default 16
+    static size_t historyBudget() {
+        const char* env = getenv("LMS_HISTORY_CACHE_MB");
+        long mb = env ? atol(env) : 0;
+        return (size_t)(mb > 0 ? mb : 16) << 20;
+    }
+
+    // archived semesters overlapping [fromKey, toKey]
+    vector<const ArchivedSemester*> archivedBetween(int fromKey, int toKey) const {
+        vector<const ArchivedSemester*> found;
+        for (const auto& a : archivedSemesters) {
+            if (a.lastKey() >= fromKey && a.firstKey() <= toKey) found.push_back(&a);
+        }
+        return found;
+    }
+
+    // Calls fn with every page of one kind from the archived semesters overlapping
+    // [fromKey, toKey], in order, keeping READ_AHEAD pages in flight ahead of the scan. Only the
+    // pages p with p % stride == offset are visited, so workers can split a scan between them.
+    template <typename Fn>
+    void scanArchive(PageKind kind, int fromKey, int toKey, int stride, int offset, Fn fn) const {
+        vector<PageCache::Key> keys;
+        for (const ArchivedSemester* a : archivedBetween(fromKey, toKey)) {
+            int first = kind == SESSION_PAGE ? 0 : a->schedulePages;
+            int count = kind == SESSION_PAGE ? a->schedulePages : a->requestPages;
+            for (int p = 0; p < count; ++p) keys.push_back(pageKey(a->semester, first + p));
+        }
+        for (size_t i = offset; i < keys.size(); i += stride) {
+            for (int ahead = 1; ahead <= READ_AHEAD && i + ahead * stride < keys.size(); ++ahead) {
+                historyCache.prefetch(keys[i + ahead * stride]);
+            }
+            shared_ptr<const HistoryPage> page = historyCache.get(keys[i]);
+            if (page) fn(*page);
+        }
+    }
+
+    // Replaces the record with record's id, or appends it; true if it was new. positions maps ids
+    // to positions in store. It is rebuilt whenever it does not agree with the store (after a
+    // load, an archive run or a local insert), so applying a long log costs O(1) per event.
+    template <typename Store, typename T, typename IdOf>
+    static bool upsert(Store& store, unordered_map<int, int>& positions, const T& record, IdOf idOf) {
+        int id = idOf(record);
+        auto it = positions.find(id);
+        bool stale = positions.size() != store.size() ||
+            (it != positions.end() && ((size_t)it->second >= store.size() || idOf(store[it->second]) != id));
+        if (stale) {
+            positions.clear();
+            for (size_t i = 0; i < store.size(); ++i) positions[idOf(store[i])] = (int)i;
+            it = positions.find(id);
+        }
+        if (it != positions.end()) {
+            store[it->second] = record;
+            return false;
+        }
+        store.push_back(record);
+        positions[id] = (int)store.size() - 1;
+        return true;
+    }
+
+    // drops all but the first record with each id
+    template <typename T, typename IdOf>
+    static void keepFirstById(vector<T>& records, IdOf idOf) {
+        set<int> seen;
+        records.erase(remove_if(records.begin(), records.end(), [&](const T& r) { return !seen.insert(idOf(r)).second; }), records.end());
+    }
+
+    template <typename T>
+    bool saveRecord(const std::string& filename, const T& record) {
+        if (batchMode) { dirtyFiles.insert(filename); return true; }
+        TraceSpan span("append", filename.c_str());
+        SystemStats& stats = SystemStats::instance();
+        ScopedTimer timer(stats.operation("append " + filename));
+        ByteWriter out;
+        if (storage->size(filename) <= 0) writeHeader(out, formatVersion<T>());
+        writeRecord(out, record);
+        if (!storage->append(filename, out.bytes.data(), out.bytes.size())) {
+            std::cerr << "ERROR: Could not open file " << filename << " for saving." << std::endl;
+            return false;
+        }
+        SystemStats::FileCounters& counters = stats.file(filename);
+        counters.bytesWritten += out.bytes.size();
+        counters.appends++;
+        return true;
+    }
+
+    template <typename Store>
+    bool saveAllRecords(const std::string& filename, const Store& records) {
+        typedef typename Store::value_type T;
+        const size_t FLUSH_BYTES = 1 << 20;
+        if (batchMode) { dirtyFiles.insert(filename); return true; }
+        TraceSpan span("rewrite", filename.c_str());
+        SystemStats& stats = SystemStats::instance();
+        ScopedTimer timer(stats.operation("rewrite " + filename));
+        // Chunks go to a temporary file that is then renamed over the old one, so a reader (a
+        // replica taking a snapshot) never sees a truncated or half-written file.
+        string temporary = filename + ".tmp";
+        ByteWriter out;
+        unsigned long long written = 0;
+        auto flush = [&] {
+            bool ok = written == 0 ? storage->write(temporary, out.bytes.data(), out.bytes.size())
+                : storage->append(temporary, out.bytes.data(), out.bytes.size());
+            written += out.bytes.size();
+            out.bytes.clear();
+            return ok;
+        };
+        writeHeader(out, formatVersion<T>());
+        bool ok = true;
+        for (const auto& record : records) {
+            writeRecord(out, record);
+            if (out.bytes.size() >= FLUSH_BYTES) ok = flush() && ok;
+        }
+        ok = flush() && ok;
+        ok = ok && storage->rename(temporary, filename);
+        if (!ok) {
+            std::cerr << "ERROR: Could not open file " << filename << " for overwriting." << std::endl;
+            storage->remove(temporary);
+            return false;
+        }
+        SystemStats::FileCounters& counters = stats.file(filename);
+        counters.bytesWritten += written;
+        counters.rewrites++;
+        return true;
+    }
+
+
+
+
+public:
+
+    SlabStore<Person> persons;
+    SlabStore<Room> rooms;
+    SlabStore<Course> courses;
+    SlabStore<LabSection> labSections;
+    ScheduleStore schedules;
+    SlabStore<MakeupRequest> requests;
+    SlabStore<Building> buildings;
+    SlabStore<Holiday> holidays;
+
+
+    int getNextId(int& staticIdCounter) {
+        return ++staticIdCounter;
+    }
+
+    explicit DataManager(shared_ptr<StorageEngine> engine = StorageEngine::standard())
+        : storage(engine), historyCache([this](PageCache::Key key) { return loadPage(key); }, historyBudget()) {
+        changes.open(*storage);
+        loadAllData();
+    }
+
+    void loadAllData() {
+        TraceSpan span("loadAllData");
+        persons.clear(); rooms.clear(); courses.clear(); labSections.clear();
+        schedules.clear(); requests.clear(); buildings.clear(); holidays.clear();
+        // older files are rewritten in the current format once loaded
+        loadTable(PERSONS_FILE, persons);
+        loadTable(ROOMS_FILE, rooms);
+        if (fileVersion(LABS_FILE) == 0) migrateLegacyLabs();
+        loadTable(COURSES_FILE, courses);
+        if (fileVersion(LABS_FILE) != 0) loadTable(LABS_FILE, labSections);
+        loadTable(SCHEDULES_FILE, schedules);
+        loadTable(MAKEUP_FILE, requests);
+        loadTable(BUILDINGS_FILE, buildings);
+        loadTable(HOLIDAYS_FILE, holidays);
+        archivedSemesters.clear();
+        historyCache.clear();
+        loadTable(ARCHIVE_INDEX_FILE, archivedSemesters);
+        migrateArchives();
+        rebuildCourseIndexes();
+        rebuildScheduleIndexes();
+        rebuildSearchIndex();
+        for (int t = (int)ChangeTable::Person; t <= (int)ChangeTable::Holiday; ++t) touch((ChangeTable)t);
+        touchAllSections();
+        archiveStamp = ++versionClock;
+
+        // Update static ID counters based on loaded data
+        for (const auto& p : persons) if (p.personId > nextPersonId) nextPersonId = p.personId;
+        for (const auto& r : rooms) if (r.roomId > nextRoomId) nextRoomId = r.roomId;
+        for (const auto& c : courses) if (c.courseId > nextCourseId) nextCourseId = c.courseId;
+        for (const auto& l : labSections) if (l.sectionId > nextLabSectionId) nextLabSectionId = l.sectionId;
+        for (size_t i = 0; i < schedules.size(); ++i) if (schedules.scheduleId(i) > nextScheduleId) nextScheduleId = schedules.scheduleId(i);
+        for (const auto& m : requests) if (m.requestId > nextMakeupId) nextMakeupId = m.requestId;
+        for (const auto& b : buildings) if (b.buildingId > nextBuildingId) nextBuildingId = b.buildingId;
+        for (const auto& h : holidays) if (h.holidayId > nextHolidayId) nextHolidayId = h.holidayId;
+        for (const auto& a : archivedSemesters) {
+            nextScheduleId = max(nextScheduleId, a.maxScheduleId);
+            nextMakeupId = max(nextMakeupId, a.maxRequestId);
+        }
+    }
+
+
+    // Groups many mutations into a single rewrite per touched file (bulk import, scripted runs)
+    void beginBatch() { batchMode = true; }
+
+    bool commitBatch() {
+        TraceSpan span("commitBatch");
+        batchMode = false;
+        bool ok = true;
+        if (dirtyFiles.count(PERSONS_FILE)) ok = saveAllRecords(PERSONS_FILE, persons) && ok;
+        if (dirtyFiles.count(BUILDINGS_FILE)) ok = saveAllRecords(BUILDINGS_FILE, buildings) && ok;
+        if (dirtyFiles.count(ROOMS_FILE)) ok = saveAllRecords(ROOMS_FILE, rooms) && ok;
+        if (dirtyFiles.count(COURSES_FILE)) ok = saveAllRecords(COURSES_FILE, courses) && ok;
+        if (dirtyFiles.count(LABS_FILE)) ok = saveAllRecords(LABS_FILE, labSections) && ok;
+        // archive index before the active files it was split from
+        if (dirtyFiles.count(ARCHIVE_INDEX_FILE)) ok = saveAllRecords(ARCHIVE_INDEX_FILE, archivedSemesters) && ok;
+        if (dirtyFiles.count(SCHEDULES_FILE)) ok = saveAllRecords(SCHEDULES_FILE, schedules) && ok;
+        if (dirtyFiles.count(MAKEUP_FILE)) ok = saveAllRecords(MAKEUP_FILE, requests) && ok;
+        if (dirtyFiles.count(HOLIDAYS_FILE)) ok = saveAllRecords(HOLIDAYS_FILE, holidays) && ok;
+        dirtyFiles.clear();
+        return changes.flush() && ok;
+    }
+
+    static void initializeStaticIds() {
+        nextPersonId = 1000;
+        nextLabSectionId = 2000;
+        nextRoomId = 3000;
+        nextScheduleId = 4000;
+        nextMakeupId = 5000;
+        nextBuildingId = 6000;
+        nextCourseId = 7000;
+        nextHolidayId = 8000;
+    }
+
+    // person management
+    int addPerson(const string& name, Role role, const string& password) {
+        int newId = getNextId(nextPersonId);
+        Person p(newId, name, role, password);
+        persons.push_back(p);
+        saveRecord(PERSONS_FILE, p);
+        recordChange(ChangeTable::Person, ChangeKind::Insert, newId, p);
+        return newId;
+    }
+
+    // venue management
+    int addBuilding(const string& name, const string& address, int attendantId) {
+        int newId = getNextId(nextBuildingId);
+        Building b(newId, name, address, attendantId);
+        buildings.push_back(b);
+        saveRecord(BUILDINGS_FILE, b);
+        recordChange(ChangeTable::Building, ChangeKind::Insert, newId, b);
+        return newId;
+    }
+
+    int addRoom(const string& roomName, int buildingId) {
+        int newId = getNextId(nextRoomId);
+        Room r(newId, roomName, buildingId);
+        rooms.push_back(r);
+        roomPositions[newId] = (int)rooms.size() - 1;
+        occupancy.addRoom();
+        actualOccupancy.addRoom();
+        saveRecord(ROOMS_FILE, r);
+        recordChange(ChangeTable::Room, ChangeKind::Insert, newId, r);
+        return newId;
+    }
+
+    // course / lab section management
+    int addCourse(const string& courseCode, const string& courseName) {
+        int newId = getNextId(nextCourseId);
+        Course c(newId, courseCode, courseName);
+        courses.push_back(c);
+        coursePositions[newId] = (int)courses.size() - 1;
+        courseCodeIndex[courseCode] = newId;
+        saveRecord(COURSES_FILE, c);
+        recordChange(ChangeTable::Course, ChangeKind::Insert, newId, c);
+        return newId;
+    }
+
+    int addLabSection(int courseId, const string& sectionName) {
+        int newId = getNextId(nextLabSectionId);
+        LabSection ls(courseId, newId, sectionName);
+        labSections.push_back(ls);
+        saveRecord(LABS_FILE, ls);
+        recordChange(ChangeTable::LabSection, ChangeKind::Insert, newId, ls);
+        return newId;
+    }
+
+    bool assignInstructor(long long sectionId, long long insId) {
+        for (auto& ls : labSections) {
+            if (ls.sectionId == sectionId) {
+                ls.instructorId = insId;
+                bool ok = saveAllRecords(LABS_FILE, labSections);
+                recordChange(ChangeTable::LabSection, ChangeKind::Update, ls.sectionId, ls);
+                return ok;
+            }
+        }
+        return false;
+    }
+
+    bool assignTA(int sectionId, int taId) {
+        for (auto& ls : labSections) {
+            if (ls.sectionId == sectionId) {
+                if (!ls.addTA(taId)) return false;
+                bool ok = saveAllRecords(LABS_FILE, labSections);
+                recordChange(ChangeTable::LabSection, ChangeKind::Update, ls.sectionId, ls);
+                return ok;
+            }
+        }
+        return false;
+    }
+
+    //Scheduling Management
+    int addScheduleEntry(int sectionId, int roomId, const Date& date, const Time& start, const Time& end, bool isMakeup = false) {
+        int newId = getNextId(nextScheduleId);
+        ScheduleEntry se(newId, sectionId, roomId, date, start, end, isMakeup);
+        schedules.push_back(se);
+        indexSchedule((int)schedules.size() - 1);
+        scheduleIdIndex[newId] = (int)schedules.size() - 1;
+        markOccupied(schedules.size() - 1);
+        saveRecord(SCHEDULES_FILE, se);
+        recordChange(ChangeTable::Schedule, ChangeKind::Insert, newId, se);
+        return newId;
+    }
+
+    // Bulk cancellation: walks only the dates in [from, to] through the date index,
+    // marks every matching pending session canceled and rewrites the file once.
+    // A filter of 0 matches everything. Returns the number of sessions canceled, -1 on save failure.
+    int cancelSchedules(const Date& from, const Date& to, int buildingId = 0, int sectionId = 0, int instructorId = 0) {
+        TraceSpan span("cancelSchedules");
+        vector<int> canceled;
+        set<pair<int, int>> touched; // (day, room) bitmaps to recompute
+        auto first = scheduleDateIndex.lower_bound(from.toKey());
+        auto last = scheduleDateIndex.upper_bound(to.toKey());
+        for (auto it = first; it != last; ++it) {
+            for (int pos : it->second) {
+                if (schedules.isCanceled(pos) || schedules.status(pos) == 1) continue;
+                if (sectionId != 0 && schedules.sectionId(pos) != sectionId) continue;
+                if (buildingId != 0) {
+                    const Room* r = getRoomById(schedules.roomId(pos));
+                    if (!r || r->buildingId != buildingId) continue;
+                }
+                if (instructorId != 0) {
+                    const LabSection* ls = getLabSectionById(schedules.sectionId(pos));
+                    if (!ls || ls->instructorId != instructorId) continue;
+                }
+                schedules.setCanceled(pos);
+                canceled.push_back(pos);
+                touched.insert(make_pair(it->first, schedules.roomId(pos)));
+            }
+        }
+        for (const auto& t : touched) refreshOccupancy(t.first, t.second);
+        if (canceled.empty()) return 0;
+        bool ok = saveAllRecords(SCHEDULES_FILE, schedules);
+        for (int pos : canceled) queueChange(ChangeTable::Schedule, ChangeKind::Update, schedules.scheduleId(pos), schedules[pos]);
+        if (!batchMode) changes.flush();
+        return ok ? (int)canceled.size() : -1;
+    }
+
+    // Holiday / leave calendar
+    int addHoliday(const Date& from, const Date& to, const string& description, int buildingId = 0, int sectionId = 0, int instructorId = 0) {
+        int newId = getNextId(nextHolidayId);
+        Holiday h(newId, from, to, description, buildingId, sectionId, instructorId);
+        holidays.push_back(h);
+        saveRecord(HOLIDAYS_FILE, h);
+        recordChange(ChangeTable::Holiday, ChangeKind::Insert, newId, h);
+        return newId;
+    }
+
+    // The holiday or leave that rules out a session of sectionId in roomId on date, if any. Like
+    // cancelSchedules, every scope a holiday sets must match. With roomId 0 the room is not chosen
+    // yet and building holidays are skipped; check again once it is.
+    const Holiday* getHoliday(const Date& date, int sectionId, int roomId = 0) const {
+        const LabSection* ls = nullptr;
+        const Room* room = nullptr;
+        for (const auto& h : holidays) {
+            if (!h.covers(date)) continue;
+            if (h.sectionId != 0 && h.sectionId != sectionId) continue;
+            if (h.instructorId != 0) {
+                if (!ls) ls = getLabSectionById(sectionId);
+                if (!ls || ls->instructorId != h.instructorId) continue;
+            }
+            if (h.buildingId != 0) {
+                if (!room && roomId != 0) room = getRoomById(roomId);
+                if (!room || room->buildingId != h.buildingId) continue;
+            }
+            return &h;
+        }
+        return nullptr;
+    }
+
+    bool updateScheduleActualTime(int scheduleId, const Time& actualStart, const Time& actualEnd) {
+        auto it = scheduleIdIndex.find(scheduleId);
+        if (it == scheduleIdIndex.end()) return false;
+        schedules.setActual(it->second, actualStart, actualEnd);
+        refreshOccupancy(schedules.dateKey(it->second), schedules.roomId(it->second));
+        bool ok = saveAllRecords(SCHEDULES_FILE, schedules);
+        recordChange(ChangeTable::Schedule, ChangeKind::Update, scheduleId, schedules[it->second]);
+        return ok;
+    }
+
+    // schedules are stored by column, so the entry is copied out; false if there is no such ID
+    bool getScheduleById(int id, ScheduleEntry& se) const {
+        auto it = scheduleIdIndex.find(id);
+        if (it == scheduleIdIndex.end()) return false;
+        se = schedules[it->second];
+        return true;
+    }
+
+    // Plans a schedule query. Instructor and TA filters become the set of their sections, and
+    // building and attendant filters the set of their rooms; each of the date, section and room indexes that applies is
+    // costed by the number of positions it would hand out, and the cheapest one (or a full scan,
+    // if none beats it) drives the range. Filters that rule everything out give an empty range.
+    ScheduleRange select(const ScheduleQuery& q) const {
+        SystemStats& stats = SystemStats::instance();
+        stats.scheduleQueries.fetch_add(1, memory_order_relaxed);
+        bool anySection = q.sectionId == 0 && q.instructorId == 0 && q.taId == 0;
+        bool anyRoom = q.roomId == 0 && q.buildingId == 0 && q.attendantId == 0;
+        vector<int> sectionIds, roomIds;
+        if (!anySection) {
+            for (const auto& ls : labSections) {
+                if (q.sectionId != 0 && ls.sectionId != q.sectionId) continue;
+                if (q.instructorId != 0 && ls.instructorId != q.instructorId) continue;
+                if (q.taId != 0 && find(ls.taIds.begin(), ls.taIds.end(), q.taId) == ls.taIds.end()) continue;
+                sectionIds.push_back(ls.sectionId);
+            }
+            // a session may name a section that is no longer in labs.dat
+            if (q.sectionId != 0 && q.instructorId == 0 && q.taId == 0 && sectionIds.empty()) sectionIds.push_back(q.sectionId);
+            sort(sectionIds.begin(), sectionIds.end());
+        }
+        if (!anyRoom) {
+            if (q.buildingId == 0 && q.attendantId == 0) roomIds.push_back(q.roomId);
+            else {
+                for (const auto& r : rooms) {
+                    if (q.roomId != 0 && r.roomId != q.roomId) continue;
+                    if (q.buildingId != 0 && r.buildingId != q.buildingId) continue;
+                    if (q.attendantId != 0) {
+                        const Building* b = getBuildingById(r.buildingId);
+                        if (!b || b->attendantId != q.attendantId) continue;
+                    }
+                    roomIds.push_back(r.roomId);
+                }
+            }
+            sort(roomIds.begin(), roomIds.end());
+        }
+        if ((!anySection && sectionIds.empty()) || (!anyRoom && roomIds.empty()) || q.fromKey > q.toKey) {
+            return ScheduleRange(schedules, ScheduleRange::EMPTY, vector<int>(), q, anySection, sectionIds, anyRoom, roomIds);
+        }
+
+        auto cost = [](const unordered_map<int, vector<int>>& index, const vector<int>& ids) {
+            size_t n = 0;
+            for (int id : ids) {
+                auto it = index.find(id);
+                if (it != index.end()) n += it->second.size();
+            }
+            return n;
+        };
+        ScheduleRange::Plan plan = ScheduleRange::FULL_SCAN;
+        size_t best = schedules.size();
+        if (!anySection && cost(scheduleSectionIndex, sectionIds) < best) {
+            plan = ScheduleRange::SECTION_INDEX;
+            best = cost(scheduleSectionIndex, sectionIds);
+        }
+        if (!anyRoom && cost(scheduleRoomIndex, roomIds) < best) {
+            plan = ScheduleRange::ROOM_INDEX;
+            best = cost(scheduleRoomIndex, roomIds);
+        }
+        auto first = scheduleDateIndex.lower_bound(q.fromKey);
+        auto last = scheduleDateIndex.upper_bound(q.toKey);
+        if (q.fromKey > 0 || q.toKey < 99991231) {
+            size_t n = 0;
+            for (auto it = first; it != last && n < best; ++it) n += it->second.size();
+            if (n < best) {
+                plan = ScheduleRange::DATE_INDEX;
+                best = n;
+            }
+        }
+
+        vector<int> positions;
+        positions.reserve(plan == ScheduleRange::FULL_SCAN ? 0 : best);
+        auto gather = [&](const unordered_map<int, vector<int>>& index, const vector<int>& ids) {
+            for (int id : ids) {
+                auto it = index.find(id);
+                if (it != index.end()) positions.insert(positions.end(), it->second.begin(), it->second.end());
+            }
+        };
+        if (plan == ScheduleRange::SECTION_INDEX) gather(scheduleSectionIndex, sectionIds);
+        else if (plan == ScheduleRange::ROOM_INDEX) gather(scheduleRoomIndex, roomIds);
+        else if (plan == ScheduleRange::DATE_INDEX) {
+            for (auto it = first; it != last; ++it) positions.insert(positions.end(), it->second.begin(), it->second.end());
+        }
+        stats.scheduleQueryEntriesVisited.fetch_add(best, memory_order_relaxed);
+        return ScheduleRange(schedules, plan, move(positions), q, anySection, move(sectionIds), anyRoom, move(roomIds));
+    }
+
+    // One page of sessions in date order (schedule order within a day) for paged listings: up to
+    // count positions that filter contains, from cursor on. The cursor moves past the page. The
+    // walk starts at the cursor's day in the date index, so a page costs the same however many
+    // sessions there are. Returns false when the walk reached the end.
+    bool scheduleDatePage(const ScheduleRange& filter, ScheduleCursor& cursor, size_t count, vector<size_t>& page) const {
+        page.clear();
+        for (auto it = scheduleDateIndex.lower_bound(cursor.dateKey); it != scheduleDateIndex.end(); ++it) {
+            size_t i = it->first == cursor.dateKey ? cursor.skip : 0;
+            for (; i < it->second.size(); ++i) {
+                if (page.size() == count) {
+                    cursor.dateKey = it->first;
+                    cursor.skip = i;
+                    return true;
+                }
+                if (filter.contains(it->second[i])) page.push_back(it->second[i]);
+            }
+        }
+        cursor.dateKey = scheduleDateIndex.empty() ? cursor.dateKey : scheduleDateIndex.rbegin()->first + 1;
+        cursor.skip = 0;
+        return false;
+    }
+
+    // Makeup Request Management
+    int addMakeupRequest(int sectionId, int instructorId, const Date& date, const Time& start, const Time& end, const string& reason) {
+        int newId = getNextId(nextMakeupId);
+        MakeupRequest mr(newId, sectionId, instructorId, date, start, end, reason);
+        requests.push_back(mr);
+        saveRecord(MAKEUP_FILE, mr);
+        recordChange(ChangeTable::MakeupRequest, ChangeKind::Insert, newId, mr);
+        return newId;
+    }
+
+    bool updateMakeupRequestStatus(int requestId, int status) {
+        for (auto& mr : requests) {
+            if (mr.requestId == requestId) {
+                mr.status = status;
+                bool ok = saveAllRecords(MAKEUP_FILE, requests);
+                recordChange(ChangeTable::MakeupRequest, ChangeKind::Update, requestId, mr);
+                return ok;
+            }
+        }
+        return false;
+    }
+
+    const Person* getPersonById(int id) const {
+        SystemStats::instance().idLookups.fetch_add(1, memory_order_relaxed);
+        for (const auto& p : persons) {
+            if (p.personId == id) return &p;
+        }
+        return nullptr;
+    }
+
+    const Course* getCourseById(int id) const {
+        SystemStats::instance().idLookups.fetch_add(1, memory_order_relaxed);
+        auto it = coursePositions.find(id);
+        return it == coursePositions.end() ? nullptr : &courses[it->second];
+    }
+
+    const Course* getCourseByCode(const string& code) const {
+        auto it = courseCodeIndex.find(code);
+        return it == courseCodeIndex.end() ? nullptr : getCourseById(it->second);
+    }
+
+    // "CS101-A"
+    string getFullSectionCode(const LabSection& ls) const {
+        const Course* c = getCourseById(ls.courseId);
+        return (c ? c->courseCode : "?") + "-" + ls.sectionName;
+    }
+
+    string getCourseName(const LabSection& ls) const {
+        const Course* c = getCourseById(ls.courseId);
+        return c ? c->courseName : "N/A";
+    }
+
+    const LabSection* getLabSectionById(int id) const {
+        SystemStats::instance().idLookups.fetch_add(1, memory_order_relaxed);
+        for (const auto& ls : labSections) {
+            if (ls.sectionId == id) return &ls;
+        }
+        return nullptr;
+    }
+
+    const Room* getRoomById(int id) const {
+        SystemStats::instance().idLookups.fetch_add(1, memory_order_relaxed);
+        for (const auto& r : rooms) {
+            if (r.roomId == id) return &r;
+        }
+        return nullptr;
+    }
+
+    const Building* getBuildingById(int id) const {
+        SystemStats::instance().idLookups.fetch_add(1, memory_order_relaxed);
+        for (const auto& b : buildings) {
+            if (b.buildingId == id) return &b;
+        }
+        return nullptr;
+    }
+
+    const SlabStore<Room>& getRooms() const { return rooms; }
+    const SlabStore<Building>& getBuildings() const { return buildings; }
+    const SlabStore<Course>& getCourses() const { return courses; }
+    const SlabStore<LabSection>& getLabSections() const { return labSections; }
+    const ScheduleStore& getSchedules() const { return schedules; }
+    const SlabStore<MakeupRequest>& getRequests() const { return requests; }
+    const SlabStore<Holiday>& getHolidays() const { return holidays; }
+    const OccupancyIndex& getOccupancy() const { return occupancy; }
+    const OccupancyIndex& getActualOccupancy() const { return actualOccupancy; }
+
+    // Moves the sessions and makeup requests of every semester that ended before cutoff's
+    // semester out of schedules.dat / makeup_requests.dat into the archive tier, one file per
+    // semester (records that arrive later for an archived semester are merged into its file).
+    // The remaining records are compacted in place: schedule positions change and the indexes are
+    // rebuilt, and pointers to makeup requests after the first archived one are invalidated.
+    // Returns the number of sessions moved, or -1 if an archive file could not be written.
+    int archiveSemestersBefore(const Date& cutoff) {
+        TraceSpan span("archiveSemesters");
+        int current = ArchivedSemester::of(cutoff.toKey());
+        map<int, pair<vector<ScheduleEntry>, vector<MakeupRequest>>> closing;
+        for (size_t i = 0; i < schedules.size(); ++i) {
+            int semester = ArchivedSemester::of(schedules.dateKey(i));
+            if (semester < current) closing[semester].first.push_back(schedules[i]);
+        }
+        for (const auto& mr : requests) {
+            int semester = ArchivedSemester::of(mr.requestedDate.toKey());
+            if (semester < current) closing[semester].second.push_back(mr);
+        }
+        if (closing.empty()) return 0;
+
+        int moved = 0;
+        for (auto& c : closing) {
+            int semester = c.first;
+            vector<ScheduleEntry>& sessions = c.second.first;
+            vector<MakeupRequest>& reqs = c.second.second;
+            moved += (int)sessions.size();
+            auto entry = lower_bound(archivedSemesters.begin(), archivedSemesters.end(), semester,
+                [](const ArchivedSemester& a, int s) { return a.semester < s; });
+            bool known = entry != archivedSemesters.end() && entry->semester == semester;
+            if (known) {
+                if (!readArchive(semester, sessions, reqs)) return -1;
+                // a record already archived is replaced by its active copy; a replica that
+                // started from files copied mid-archive can see the same semester archived twice
+                keepFirstById(sessions, [](const ScheduleEntry& se) { return se.scheduleId; });
+                keepFirstById(reqs, [](const MakeupRequest& mr) { return mr.requestId; });
+            }
+
+            ArchivedSemester info(semester);
+            if (!writeArchive(info, sessions, reqs)) return -1;
+            if (known) *entry = info;
+            else archivedSemesters.insert(entry, info);
+        }
+        historyCache.clear();
+
+        // the index goes first: a crash before the active files are rewritten leaves records in
+        // both tiers rather than in neither
+        bool ok = saveAllRecords(ARCHIVE_INDEX_FILE, archivedSemesters);
+        schedules.eraseIf([&](size_t i) { return ArchivedSemester::of(schedules.dateKey(i)) < current; });
+        requests.eraseIf([&](size_t i) { return ArchivedSemester::of(requests[i].requestedDate.toKey()) < current; });
+        applyPositions[(int)ChangeTable::MakeupRequest].clear();
+        rebuildScheduleIndexes();
+        touch(ChangeTable::Schedule);
+        touch(ChangeTable::MakeupRequest);
+        touchAllSections();
+        archiveStamp = ++versionClock;
+        ok = saveAllRecords(SCHEDULES_FILE, schedules) && ok;
+        ok = saveAllRecords(MAKEUP_FILE, requests) && ok;
+        if (captureChanges) {
+            changes.add(ChangeTable::Schedule, ChangeKind::Archive, 0, cutoff.toKey(), string());
+            if (!batchMode) ok = changes.flush() && ok;
+        }
+        return ok ? moved : -1;
+    }
+
+    const vector<ArchivedSemester>& getArchivedSemesters() const { return archivedSemesters; }
+
+    StorageEngine& getStorage() const { return *storage; }
+
+    // the sequence number of the last change logged; a consumer that starts from a copy of the
+    // data files made after reading this can tail the log from here
+    uint64_t lastChangeSequence() const { return changes.lastSequenceNumber(); }
+    // off for bulk loads that are a fresh baseline rather than a stream of changes
+    void setChangeCapture(bool on) { captureChanges = on; }
+
+    // ranked type-ahead matches for query among person, course, room and building names
+    // (only one of those tables unless only is 0); see SearchIndex
+    vector<SearchIndex::Hit> search(const string& query, size_t limit = 10, ChangeTable only = (ChangeTable)0) const {
+        return searchIndex.find(query, limit, only);
+    }
+    size_t searchableRecords() const { return searchIndex.size(); }
+
+    // versions for caching derived results: a value changes whenever the data behind it does
+    uint64_t dataVersion(ChangeTable table) const { return tableVersions[(int)table]; }
+    uint64_t sectionVersion(int sectionId) const {
+        auto it = sectionVersions.find(sectionId);
+        return it == sectionVersions.end() ? sectionBaseVersion : it->second;
+    }
+    uint64_t archiveVersion() const { return archiveStamp; }
+    // ids of the sections that have sessions in the active store, including ones missing from labs.dat
+    vector<int> scheduledSections() const {
+        vector<int> ids;
+        for (const auto& s : scheduleSectionIndex) {
+            if (!s.second.empty()) ids.push_back(s.first);
+        }
+        return ids;
+    }
+
+    // Applies one event from another DataManager's change log to the tables in memory, for read
+    // replicas; nothing is written to storage except by an archive event. Inserts and updates
+    // replace the record with the same id, so replaying an event already applied changes nothing.
+    // False if the record cannot be decoded.
+    bool applyChange(const ChangeEvent& e) {
+        if (e.table < ChangeTable::Person || e.table > ChangeTable::Holiday) return false;
+        ByteReader in(e.record.data(), e.record.data() + e.record.size());
+        touch(e.table);
+        switch (e.table) {
+        case ChangeTable::Person: {
+            Person p;
+            if (!readRecord(in, p, e.format)) return false;
+            upsert(persons, applyPositions[(int)e.table], p, [](const Person& x) { return x.personId; });
+            indexForSearch(p);
+            return true;
+        }
+        case ChangeTable::Building: {
+            Building b;
+            if (!readRecord(in, b, e.format)) return false;
+            upsert(buildings, applyPositions[(int)e.table], b, [](const Building& x) { return x.buildingId; });
+            indexForSearch(b);
+            return true;
+        }
+        case ChangeTable::Room: {
+            Room r;
+            if (!readRecord(in, r, e.format)) return false;
+            if (upsert(rooms, roomPositions, r, [](const Room& x) { return x.roomId; })) {
+                occupancy.addRoom();
+                actualOccupancy.addRoom();
+            }
+            indexForSearch(r);
+            return true;
+        }
+        case ChangeTable::Course: {
+            Course c;
+            if (!readRecord(in, c, e.format)) return false;
+            const Course* old = getCourseById(c.courseId);
+            if (old && old->courseCode != c.courseCode) courseCodeIndex.erase(old->courseCode);
+            upsert(courses, coursePositions, c, [](const Course& x) { return x.courseId; });
+            courseCodeIndex[c.courseCode] = c.courseId;
+            indexForSearch(c);
+            return true;
+        }
+        case ChangeTable::LabSection: {
+            LabSection ls;
+            if (!readRecord(in, ls, e.format)) return false;
+            upsert(labSections, applyPositions[(int)e.table], ls, [](const LabSection& x) { return x.sectionId; });
+            return true;
+        }
+        case ChangeTable::Schedule: {
+            if (e.kind == ChangeKind::Archive) return archiveSemestersBefore(Date::fromKey(e.id)) >= 0;
+            ScheduleEntry se;
+            if (!readRecord(in, se, e.format)) return false;
+            touchSection(se);
+            auto it = scheduleIdIndex.find(se.scheduleId);
+            if (it == scheduleIdIndex.end()) {
+                schedules.push_back(se);
+                indexSchedule((int)schedules.size() - 1);
+                scheduleIdIndex[se.scheduleId] = (int)schedules.size() - 1;
+                markOccupied(schedules.size() - 1);
+                return true;
+            }
+            int pos = it->second, oldKey = schedules.dateKey(pos), oldRoom = schedules.roomId(pos);
+            bool moved = oldKey != se.scheduledDate.toKey() || oldRoom != se.roomId || schedules.sectionId(pos) != se.sectionId;
+            if (schedules.sectionId(pos) != se.sectionId) touchSection(schedules[pos]);
+            if (moved) unindexSchedule(pos);
+            schedules.set(pos, se);
+            if (moved) indexSchedule(pos);
+            refreshOccupancy(oldKey, oldRoom);
+            refreshOccupancy(se.scheduledDate.toKey(), se.roomId);
+            return true;
+        }
+        case ChangeTable::MakeupRequest: {
+            MakeupRequest mr;
+            if (!readRecord(in, mr, e.format)) return false;
+            upsert(requests, applyPositions[(int)e.table], mr, [](const MakeupRequest& x) { return x.requestId; });
+            return true;
+        }
+        case ChangeTable::Holiday: {
+            Holiday h;
+            if (!readRecord(in, h, e.format)) return false;
+            upsert(holidays, applyPositions[(int)e.table], h, [](const Holiday& x) { return x.holidayId; });
+            return true;
+        }
+        }
+        return false;
+    }
+
+    // every file this data set occupies in its storage engine
+    vector<string> storedFiles() const {
+        vector<string> names{ PERSONS_FILE, ROOMS_FILE, COURSES_FILE, LABS_FILE, SCHEDULES_FILE, MAKEUP_FILE,
+            BUILDINGS_FILE, HOLIDAYS_FILE, ARCHIVE_INDEX_FILE, ChangeLog::FILE_NAME };
+        for (const auto& a : archivedSemesters) names.push_back(archiveFile(a.semester));
+        return names;
+    }
+
+    // copies every stored file into target, for work that must leave this data set as it is
+    void copyFilesTo(StorageEngine& target) const {
+        string bytes;
+        for (const auto& name : storedFiles()) {
+            if (storage->read(name, bytes)) target.write(name, bytes.data(), bytes.size());
+        }
+    }
+
+    // sessions in the archived semesters overlapping [fromKey, toKey], for sizing a scan
+    size_t archivedSessionsBetween(int fromKey, int toKey) const {
+        size_t count = 0;
+        for (const ArchivedSemester* a : archivedBetween(fromKey, toKey)) count += a->scheduleCount;
+        return count;
+    }
+
+    // Calls fn with each page of archived sessions from the semesters overlapping [fromKey, toKey],
+    // in date order; pages also hold sessions just outside the period. With stride > 1 only
+    // every stride-th page starting at offset is visited, so workers can share one scan.
+    template <typename Fn>
+    void forEachArchivedSessionPage(int fromKey, int toKey, int stride, int offset, Fn fn) const {
+        scanArchive(SESSION_PAGE, fromKey, toKey, stride, offset, fn);
+    }
+
+    // calls fn for each makeup request, active or archived, for a day in [fromKey, toKey]
+    template <typename Fn>
+    void forEachRequestBetween(int fromKey, int toKey, Fn fn) const {
+        for (const auto& mr : requests) {
+            int key = mr.requestedDate.toKey();
+            if (key >= fromKey && key <= toKey) fn(mr);
+        }
+        scanArchive(REQUEST_PAGE, fromKey, toKey, 1, 0, [&](const HistoryPage& page) {
+            for (const auto& mr : page.requests) {
+                int key = mr.requestedDate.toKey();
+                if (key >= fromKey && key <= toKey) fn(mr);
+            }
+        });
+    }
+
+    // OccupancyIndex::accumulateHourly over the active bitmaps plus the archived sessions in the
+    // period. Archived sessions are marked into scratch bitmaps a page at a time; since pages are
+    // in date order, every day before a page's last one is complete and is drained into the totals.
+    void accumulateHourly(int fromKey, int toKey, int firstHour, int lastHour,
+        vector<uint32_t>& scheduled, vector<uint32_t>& used) const {
+        occupancy.accumulateHourly(fromKey, toKey, firstHour, lastHour, scheduled);
+        actualOccupancy.accumulateHourly(fromKey, toKey, firstHour, lastHour, used);
+        if (archivedBetween(fromKey, toKey).empty()) return;
+        OccupancyIndex expected, actual;
+        expected.reset(occupancy.rooms());
+        actual.reset(occupancy.rooms());
+        scanArchive(SESSION_PAGE, fromKey, toKey, 1, 0, [&](const HistoryPage& page) {
+            if (page.sessions.empty()) return;
+            for (const auto& se : page.sessions) {
+                int key = se.scheduledDate.toKey();
+                if (key >= fromKey && key <= toKey) markSession(se, expected, actual);
+            }
+            int open = page.sessions.back().scheduledDate.toKey();
+            expected.drainHourly(open, firstHour, lastHour, scheduled);
+            actual.drainHourly(open, firstHour, lastHour, used);
+        });
+        expected.drainHourly(toKey + 1, firstHour, lastHour, scheduled);
+        actual.drainHourly(toKey + 1, firstHour, lastHour, used);
+    }
+
+    // All rooms free for [start, end) on date, from one sweep over the occupancy bitmaps;
+    // only rooms whose bitmap overlap is not exact fall back to isRoomAvailable.
+    vector<const Room*> findFreeRooms(const Date& date, const Time& start, const Time& end) const {
+        TraceSpan span("findFreeRooms");
+        vector<uint8_t> state;
+        occupancy.scan(date.toKey(), start, end, state);
+        vector<const Room*> freeRooms;
+        for (size_t r = 0; r < state.size() && r < rooms.size(); ++r) {
+            if (state[r] == OccupancyIndex::FREE ||
+                (state[r] == OccupancyIndex::CHECK && isRoomAvailable(rooms[r].roomId, date, start, end))) {
+                freeRooms.push_back(&rooms[r]);
+            }
+        }
+        return freeRooms;
+    }
+
+    bool isRoomAvailable(int roomId, const Date& date, const Time& start, const Time& end) const {
+        TraceSpan span("isRoomAvailable");
+        SystemStats& stats = SystemStats::instance();
+        stats.roomChecks.fetch_add(1, memory_order_relaxed);
+        auto day = scheduleDateIndex.find(date.toKey());
+        if (day == scheduleDateIndex.end()) return true;
+        stats.roomCheckEntriesScanned.fetch_add(day->second.size(), memory_order_relaxed);
+        int startMin = start.getHour() * 60 + start.getMinute(), endMin = end.getHour() * 60 + end.getMinute();
+        for (int pos : day->second) {
+            if (schedules.roomId(pos) == roomId && schedules.blocks(pos, startMin, endMin)) {
+                return false; 
+            }
+        }
+        return true; 
+    }
+};
+
+
+int DataManager::nextPersonId = 1000;
+int DataManager::nextLabSectionId = 2000;
+int DataManager::nextRoomId = 3000;
+int DataManager::nextScheduleId = 4000;
+int DataManager::nextMakeupId = 5000;
+int DataManager::nextBuildingId = 6000;
+int DataManager::nextCourseId = 7000; 
+int DataManager::nextHolidayId = 8000;
+
+// authentication
+class Authentication {
+private:
+    DataManager& dm;
+
+public:
+    Authentication(DataManager& dataManager) : dm(dataManager) {}
+
+    const Person* authenticate(long long id, const std::string& password) const {
+        const Person* p = dm.getPersonById(id);
+        if (p && password == p->password) {
+            return p;
+        }
+        return nullptr;
+    }
+};
+
+class LabManagementSystem;
+
+// reports
+
+class HoDReportGenerator {
+private:
+    DataManager& dm;
+
+    bool writeReportFile(const std::string& filename, const string& content) const {
+        TraceSpan span("report.writeFile");
+        ScopedTimer timer(SystemStats::instance().operation("report.writeFile"));
+        time_t now = time(0);
+        tm temp{};
+        tm* ltm = &temp;
+
+        if (localtime_s(ltm, &now) != 0) {
+            std::cerr << "\n[ERROR] Failed to get local time." << std::endl;
+            return false;
+        }
+
+        stringstream datedName;
+        datedName << filename << "_" << ltm->tm_year + 1900 << "-" << ltm->tm_mon + 1 << "-" << ltm->tm_mday << ".txt";
+
+        ofstream file(datedName.str());
+        if (file.is_open()) {
+            file << content;
+            file.close();
+            cout << "\n[SUCCESS] Report generated: " << datedName.str() << endl;
+            return true;
+        }
+        else {
+            cout << "\n[ERROR] Could not generate report file: " << datedName.str() << endl;
+            return false;
+        }
+    }
+
+    // today's local date, printed in every report's "Generated on" line
+    static string reportDate() {
+        time_t now = time(0);
+        tm local{};
+        if (localtime_s(&local, &now) != 0) return Date().toString();
+        return Date(local.tm_mday, local.tm_mon + 1, local.tm_year + 1900).toString();
+    }
+
+    // Report cache. A report's text is reused while its key (type and parameters, plus
+    // reportDate(), which the header carries) and the data versions of the tables it reads are
+    // unchanged; the file is still written on every request. The schedule report also keeps its formatted rows per
+    // section, so when a few sessions change only their sections' rows are formatted again.
+    struct CachedReport {
+        vector<uint64_t> versions;
+        string filename;
+        string text;
+    };
+    struct ScheduleRow {
+        int dateKey;
+        int startMinute;
+        int scheduleId; // ties keep schedule order
+        string text;
+    };
+    struct SectionRows {
+        uint64_t version = 0;
+        vector<ScheduleRow> rows;
+    };
+    static const size_t MAX_CACHED_REPORTS = 32;
+    mutable map<string, CachedReport> reportCache;
+    mutable unordered_map<int, SectionRows> scheduleRows;
+    mutable vector<uint64_t> scheduleRowVersions; // of the tables every row reads, besides its section
+    mutable vector<ScheduleRow> archivedRows;      // of every archived session
+    mutable vector<uint64_t> archivedRowVersions;  // scheduleRowVersions plus the archive version
+
+    vector<uint64_t> versionsOf(initializer_list<ChangeTable> tables) const {
+        vector<uint64_t> versions;
+        for (ChangeTable t : tables) versions.push_back(dm.dataVersion(t));
+        return versions;
+    }
+
+    vector<uint64_t> allVersions() const {
+        return versionsOf({ ChangeTable::Person, ChangeTable::Building, ChangeTable::Room, ChangeTable::Course,
+            ChangeTable::LabSection, ChangeTable::Schedule, ChangeTable::MakeupRequest, ChangeTable::Holiday });
+    }
+
+    // writes the cached text and returns true if key is cached at these versions
+    bool reuseReport(const string& key, const vector<uint64_t>& versions) const {
+        SystemStats& stats = SystemStats::instance();
+        auto it = reportCache.find(key + " " + reportDate());
+        if (it == reportCache.end() || it->second.versions != versions) {
+            stats.reportCacheMisses.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        stats.reportCacheHits.fetch_add(1, memory_order_relaxed);
+        writeReportFile(it->second.filename, it->second.text);
+        return true;
+    }
+
+    void storeReport(const string& key, const vector<uint64_t>& versions, const string& filename, const string& text) const {
+        writeReportFile(filename, text);
+        string dated = key + " " + reportDate();
+        if (reportCache.size() >= MAX_CACHED_REPORTS && !reportCache.count(dated)) reportCache.erase(reportCache.begin());
+        reportCache[dated] = CachedReport{ versions, filename, text };
+    }
+
+    // brings scheduleRows up to date: every section when a shared table changed, otherwise only
+    // the sections whose sessions changed
+    void refreshScheduleRows() const {
+        vector<uint64_t> shared = versionsOf({ ChangeTable::Person, ChangeTable::Building, ChangeTable::Room,
+            ChangeTable::Course, ChangeTable::LabSection });
+        if (shared != scheduleRowVersions) {
+            scheduleRows.clear();
+            scheduleRowVersions = shared;
+        }
+        vector<uint64_t> archived = shared;
+        archived.push_back(dm.archiveVersion());
+        stringstream line;
+        if (archived != archivedRowVersions) {
+            // archived rows change only with an archive run or a shared table, and are read a page at a time
+            archivedRows.clear();
+            archivedRowVersions = archived;
+            unordered_map<int, pair<string, string>> sectionNames; // code, instructor
+            dm.forEachArchivedSessionPage(0, 99991231, 1, 0, [&](const HistoryPage& page) {
+                for (const auto& se : page.sessions) {
+                    auto names = sectionNames.find(se.sectionId);
+                    if (names == sectionNames.end()) {
+                        const LabSection* ls = dm.getLabSectionById(se.sectionId);
+                        names = sectionNames.emplace(se.sectionId, make_pair(ls ? dm.getFullSectionCode(*ls) : "N/A",
+                            getPersonName(ls ? ls->getInstructorId() : 0))).first;
+                    }
+                    archivedRows.push_back(ScheduleRow{ se.scheduledDate.toKey(),
+                        se.expectedStart.getHour() * 60 + se.expectedStart.getMinute(), se.scheduleId,
+                        scheduleRowText(line, se, names->second.first, names->second.second) });
+                }
+            });
+        }
+        vector<int> sectionIds = dm.scheduledSections();
+        sort(sectionIds.begin(), sectionIds.end());
+        for (auto it = scheduleRows.begin(); it != scheduleRows.end();) {
+            if (binary_search(sectionIds.begin(), sectionIds.end(), it->first)) ++it;
+            else it = scheduleRows.erase(it);
+        }
+
+        const auto& schedules = dm.getSchedules();
+        for (int sectionId : sectionIds) {
+            SectionRows& block = scheduleRows[sectionId];
+            uint64_t version = dm.sectionVersion(sectionId);
+            if (block.version == version) continue;
+            SystemStats::instance().reportBlocksRebuilt.fetch_add(1, memory_order_relaxed);
+            block.version = version;
+            block.rows.clear();
+            const LabSection* ls = dm.getLabSectionById(sectionId);
+            string sectionCode = ls ? dm.getFullSectionCode(*ls) : "N/A";
+            string instructor = getPersonName(ls ? ls->getInstructorId() : 0);
+            for (size_t pos : dm.select(ScheduleQuery().forSection(sectionId))) {
+                block.rows.push_back(ScheduleRow{ schedules.dateKey(pos), schedules.startMinute(pos), schedules.scheduleId(pos),
+                    scheduleRowText(line, schedules[pos], sectionCode, instructor) });
+            }
+        }
+    }
+
+    string scheduleRowText(stringstream& line, const ScheduleEntry& se, const string& sectionCode, const string& instructor) const {
+        line.str("");
+        line << left << setw(15) << se.scheduledDate.toString()
+            << setw(12) << se.scheduledDate.getWeekdayString()
+            << setw(15) << se.expectedStart.toString()
+            << setw(15) << se.expectedEnd.toString()
+            << setw(25) << sectionCode
+            << setw(30) << getRoomInfo(se.roomId)
+            << setw(20) << instructor << "\n";
+        return line.str();
+    }
+
+    // Adds the archived sessions that match to active ones taken from the store in schedule order.
+    // Archived pages are streamed one at a time; since sessions are stored in id order and an
+    // archive run keeps the rest in order, sorting by id restores the order before archiving.
+    template <typename Match>
+    void sessionsWithArchive(vector<ScheduleEntry>& sessions, Match match) const {
+        size_t active = sessions.size();
+        dm.forEachArchivedSessionPage(0, 99991231, 1, 0, [&](const HistoryPage& page) {
+            for (const auto& se : page.sessions) {
+                if (match(se)) sessions.push_back(se);
+            }
+        });
+        if (sessions.size() == active) return;
+        stable_sort(sessions.begin(), sessions.end(),
+            [](const ScheduleEntry& a, const ScheduleEntry& b) { return a.scheduleId < b.scheduleId; });
+    }
+
+public:
+    HoDReportGenerator(DataManager& dataManager) : dm(dataManager) {}
+
+    // drops every cached report, so the next run of each one starts from scratch
+    void clearCache() const {
+        reportCache.clear();
+        scheduleRows.clear();
+        scheduleRowVersions.clear();
+        archivedRows.clear();
+        archivedRowVersions.clear();
+    }
 
     string getPersonName(int id) const {
         const Person* p = dm.getPersonById(id);
@@ -726,7 +4168,7 @@ public:
     // UPDATED: Use courseName and getFullSectionCode
     string getLabInfo(int id) const {
         const LabSection* ls = dm.getLabSectionById(id);
-        return ls ? ls->courseName + " (" + ls->getFullSectionCode() + ")" : "N/A";
+        return ls ? dm.getCourseName(*ls) + " (" + dm.getFullSectionCode(*ls) + ")" : "N/A";
     }
 
     string getRoomInfo(long long id) const {
@@ -739,19 +4181,36 @@ public:
     }
 
     void generateLabScheduleReport() const {
+        TraceSpan span("report.labSchedule");
+        ScopedTimer timer(SystemStats::instance().operation("report.labSchedule"));
+        vector<uint64_t> versions = versionsOf({ ChangeTable::Person, ChangeTable::Building, ChangeTable::Room,
+            ChangeTable::Course, ChangeTable::LabSection, ChangeTable::Schedule });
+        if (reuseReport("schedule", versions)) return;
         stringstream report;
         report << "--- COMPLETE LAB SCHEDULE FOR THE WEEK ---\n";
-        report << "Generated on: " << Date().toString() << "\n\n";
+        report << "Generated on: " << reportDate() << "\n\n";
 
-        const auto& schedules = dm.getSchedules();
+        TraceSpan rowsPhase("report.labSchedule.rows");
+        refreshScheduleRows();
+        rowsPhase.end();
 
-        vector<ScheduleEntry> sortedSchedules = schedules;
-        sort(sortedSchedules.begin(), sortedSchedules.end(), [](const ScheduleEntry& a, const ScheduleEntry& b) {
-            if (!(a.scheduledDate == b.scheduledDate)) return a.scheduledDate < b.scheduledDate;
-            return a.expectedStart < b.expectedStart;
+        TraceSpan sortPhase("report.labSchedule.sort");
+        vector<const ScheduleRow*> sortedRows;
+        sortedRows.reserve(dm.getSchedules().size() + archivedRows.size());
+        for (const auto& block : scheduleRows) {
+            for (const auto& row : block.second.rows) sortedRows.push_back(&row);
+        }
+        for (const auto& row : archivedRows) sortedRows.push_back(&row);
+        sort(sortedRows.begin(), sortedRows.end(), [](const ScheduleRow* a, const ScheduleRow* b) {
+            if (a->dateKey != b->dateKey) return a->dateKey < b->dateKey;
+            if (a->startMinute != b->startMinute) return a->startMinute < b->startMinute;
+            return a->scheduleId < b->scheduleId;
             });
+        sortPhase.end();
+
+        TraceSpan formatPhase("report.labSchedule.format");
 
-        if (sortedSchedules.empty()) {
+        if (sortedRows.empty()) {
             report << "No labs are currently scheduled.\n";
         }
         else {
@@ -760,68 +4219,77 @@ public:
                 << setw(20) << "Instructor" << endl;
             report << string(132, '-') << endl;
 
-            for (const auto& se : sortedSchedules) {
-                const LabSection* ls = dm.getLabSectionById(se.sectionId);
-                report << left << setw(15) << se.scheduledDate.toString()
-                    << setw(12) << se.scheduledDate.getWeekdayString()
-                    << setw(15) << se.expectedStart.toString()
-                    << setw(15) << se.expectedEnd.toString()
-                    << setw(25) << (ls ? ls->getFullSectionCode() : "N/A")
-                    << setw(30) << getRoomInfo(se.roomId)
-                    << setw(20) << getPersonName(ls ? ls->getInstructorId() : 0) << std::endl;
-            }
+            for (const ScheduleRow* row : sortedRows) report << row->text;
         }
+        formatPhase.end();
 
-        writeReportFile("LabScheduleReport", report.str());
+        storeReport("schedule", versions, "LabScheduleReport", report.str());
     }
 
     void generateTimeSheetReport(const string& targetWeek) const {
+        TraceSpan span("report.timeSheet");
+        ScopedTimer timer(SystemStats::instance().operation("report.timeSheet"));
+        vector<uint64_t> versions = versionsOf({ ChangeTable::Building, ChangeTable::Room, ChangeTable::Course,
+            ChangeTable::LabSection, ChangeTable::Schedule });
+        if (reuseReport("timesheet " + targetWeek, versions)) return;
         stringstream report;
         report << "--- FILLED TIME SHEET REPORT (Week: " << targetWeek << ") ---\n";
-        report << "Generated on: " << Date().toString() << "\n\n";
+        report << "Generated on: " << reportDate() << "\n\n";
 
         const auto& schedules = dm.getSchedules();
+        TraceSpan formatPhase("report.timeSheet.format");
 
         report << left << setw(15) << "Date" << setw(25) << "Lab Section"
             << setw(15) << "Actual Start" << setw(15) << "Actual End"
             << setw(20) << "Duration (hrs)" << setw(30) << "Venue" << std::endl;
         report << string(120, '-') << endl;
 
+        // Only filled timesheets, archived semesters included
+        vector<ScheduleEntry> filled;
+        for (size_t pos : dm.select(ScheduleQuery().withStatus(1))) filled.push_back(schedules[pos]);
+        sessionsWithArchive(filled, [](const ScheduleEntry& se) { return se.status == 1; });
+
         bool found = false;
-        for (const auto& se : schedules) {
-            if (se.status == 1) { // Only filled timesheets
-                found = true;
-                double duration = se.getActualContactHours();
-                report << left << setw(15) << se.scheduledDate.toString()
-                    << setw(25) << getLabInfo(se.sectionId)
-                    << setw(15) << se.actualStart.toString()
-                    << setw(15) << se.actualEnd.toString()
-                    << setw(20) << std::fixed << setprecision(2) << duration
-                    << setw(30) << getRoomInfo(se.roomId) << endl;
-            }
+        for (const ScheduleEntry& se : filled) {
+            found = true;
+            double duration = se.getActualContactHours();
+            report << left << setw(15) << se.scheduledDate.toString()
+                << setw(25) << getLabInfo(se.sectionId)
+                << setw(15) << se.actualStart.toString()
+                << setw(15) << se.actualEnd.toString()
+                << setw(20) << std::fixed << setprecision(2) << duration
+                << setw(30) << getRoomInfo(se.roomId) << endl;
         }
 
         if (!found) {
             report << "No timesheets filled for the specified week or in the system yet.\n";
         }
+        formatPhase.end();
 
-        writeReportFile("TimeSheetReport_" + targetWeek, report.str());
+        storeReport("timesheet " + targetWeek, versions, "TimeSheetReport_" + targetWeek, report.str());
     }
 
     void generateLabSummaryReport(int sectionId) const {
+        TraceSpan span("report.labSummary");
+        ScopedTimer timer(SystemStats::instance().operation("report.labSummary"));
         const LabSection* ls = dm.getLabSectionById(sectionId);
         if (!ls) {
             cout << "[ERROR] Invalid lab section ID." << endl;
             return;
         }
+        string key = "summary " + to_string(sectionId);
+        vector<uint64_t> versions = versionsOf({ ChangeTable::Person, ChangeTable::Course, ChangeTable::LabSection });
+        versions.push_back(dm.sectionVersion(sectionId));
+        if (reuseReport(key, versions)) return;
 
         stringstream report;
         report << "--- LAB CONTACT HOURS SUMMARY ---\n";
-        report << "Lab Section: " << ls->courseName << " (" << ls->getFullSectionCode() << ")\n";
+        report << "Lab Section: " << dm.getCourseName(*ls) << " (" << dm.getFullSectionCode(*ls) << ")\n";
         report << "Instructor: " << getPersonName(ls->getInstructorId()) << "\n";
-        report << "Generated on: " << Date().toString() << "\n\n";
+        report << "Generated on: " << reportDate() << "\n\n";
 
         const auto& schedules = dm.getSchedules();
+        TraceSpan formatPhase("report.labSummary.format");
         double totalContactHours = 0.0;
         int leavesOrCancellations = 0;
 
@@ -830,157 +4298,1567 @@ public:
             << std::setw(15) << "Duration" << std::setw(15) << "Status" << std::endl;
         report << std::string(105, '-') << std::endl;
 
-        for (const auto& se : schedules) {
-            if (se.sectionId == sectionId) {
-                double duration = se.getActualContactHours();
-                totalContactHours += duration;
+        vector<ScheduleEntry> sessions;
+        for (size_t pos : dm.select(ScheduleQuery().forSection(sectionId))) sessions.push_back(schedules[pos]);
+        sessionsWithArchive(sessions, [sectionId](const ScheduleEntry& se) { return se.sectionId == sectionId; });
+
+        for (const ScheduleEntry& se : sessions) {
+            double duration = se.getActualContactHours();
+            totalContactHours += duration;
+
+            std::string statusStr;
+            std::string actStart = "N/A";
+            std::string actEnd = "N/A";
+            std::string durationStr = "N/A";
+
+            if (se.isCanceled) {
+                statusStr = "Canceled/Leave";
+                leavesOrCancellations++;
+            }
+            else if (se.status == 1) {
+                statusStr = "Completed";
+                actStart = se.actualStart.toString();
+                actEnd = se.actualEnd.toString();
+                durationStr = std::to_string(duration);
+            }
+            else {
+                statusStr = "Scheduled";
+            }
+
+            report << std::left << std::setw(15) << se.scheduledDate.toString()
+                << std::setw(15) << se.expectedStart.toString()
+                << std::setw(15) << se.expectedEnd.toString()
+                << std::setw(15) << actStart
+                << std::setw(15) << actEnd
+                << std::setw(15) << durationStr
+                << std::setw(15) << statusStr << std::endl;
+        }
+
+        report << "\n\n--- SUMMARY ---\n";
+        report << "Total Contact Hours Logged: " << std::fixed << std::setprecision(2) << totalContactHours << " hours\n";
+        report << "Total Canceled/Leaves: " << leavesOrCancellations << " sessions\n";
+        formatPhase.end();
+
+        storeReport(key, versions, "LabSummaryReport_" + dm.getFullSectionCode(*ls), report.str());
+    }
+
+    // Room utilization heatmap and capacity planning over [from, to], built from the occupancy
+    // bitmaps: booked (scheduled) vs. actually used (filled timesheets) per weekday x hour.
+    void generateRoomUtilizationReport(const Date& from, const Date& to) const {
+        TraceSpan span("report.roomUtilization");
+        ScopedTimer timer(SystemStats::instance().operation("report.roomUtilization"));
+        string key = "utilization " + from.toString() + " " + to.toString();
+        vector<uint64_t> versions = allVersions();
+        if (reuseReport(key, versions)) return;
+        const int FIRST_HOUR = 8, LAST_HOUR = 20, HOURS = LAST_HOUR - FIRST_HOUR;
+        const int SLOTS_PER_HOUR = 60 / OccupancyIndex::SLOT_MINUTES;
+        const auto& rooms = dm.getRooms();
+
+        TraceSpan aggregatePhase("report.roomUtilization.aggregate");
+        vector<uint32_t> scheduled, used;
+        dm.accumulateHourly(from.toKey(), to.toKey(), FIRST_HOUR, LAST_HOUR, scheduled, used);
+
+        // how often each weekday occurs in the period; a room-cell holds that many hours
+        int weekdayCount[7] = { 0 };
+        for (int d = from.toDayNumber(); d <= to.toDayNumber(); ++d) weekdayCount[Date::fromDayNumber(d).getWeekday()]++;
+        long long roomWeekSlots = 0; // Mon-Sat capacity of one room over the period
+        for (int w = 1; w <= 6; ++w) roomWeekSlots += (long long)weekdayCount[w] * HOURS * SLOTS_PER_HOUR;
+
+        struct Group {
+            string name;
+            long long roomCount = 0;
+            vector<unsigned long long> booked = vector<unsigned long long>(7 * HOURS, 0);
+            vector<unsigned long long> usedSlots = vector<unsigned long long>(7 * HOURS, 0);
+            vector<int> roomPositions;
+        };
+        Group campus;
+        campus.name = "CAMPUS";
+        map<int, Group> buildings;
+        for (size_t r = 0; r < rooms.size() && r < dm.getOccupancy().rooms(); ++r) {
+            Group& b = buildings[rooms[r].buildingId];
+            b.roomCount++;
+            b.roomPositions.push_back((int)r);
+            campus.roomCount++;
+            for (int c = 0; c < 7 * HOURS; ++c) {
+                b.booked[c] += scheduled[r * 7 * HOURS + c];
+                b.usedSlots[c] += used[r * 7 * HOURS + c];
+                campus.booked[c] += scheduled[r * 7 * HOURS + c];
+                campus.usedSlots[c] += used[r * 7 * HOURS + c];
+            }
+        }
+        aggregatePhase.end();
+
+        TraceSpan formatPhase("report.roomUtilization.format");
+        auto percent = [&](unsigned long long slots, long long roomCount, int weekday) -> int {
+            long long capacity = roomCount * weekdayCount[weekday] * SLOTS_PER_HOUR;
+            return capacity > 0 ? (int)(slots * 100 / capacity) : -1;
+        };
+        auto heatmap = [&](stringstream& out, const string& title, const vector<unsigned long long>& cells, long long roomCount) {
+            out << left << setw(12) << title;
+            for (int h = FIRST_HOUR; h < LAST_HOUR; ++h) out << right << setw(5) << (h < 10 ? "0" : "") + to_string(h);
+            out << "\n";
+            static const int order[] = { 1, 2, 3, 4, 5, 6, 0 };
+            for (int w : order) {
+                out << left << setw(12) << Date(1, 1, 2024, w).getWeekdayString().substr(0, 3);
+                for (int h = 0; h < HOURS; ++h) {
+                    int p = percent(cells[w * HOURS + h], roomCount, w);
+                    out << right << setw(5) << (p < 0 ? string("-") : to_string(p));
+                }
+                out << "\n";
+            }
+        };
 
-                std::string statusStr;
-                std::string actStart = "N/A";
-                std::string actEnd = "N/A";
-                std::string durationStr = "N/A";
+        stringstream report;
+        report << "--- ROOM UTILIZATION & CAPACITY REPORT ---\n";
+        report << "Period: " << from.toString() << " to " << to.toString() << "\n";
+        report << "Generated on: " << reportDate() << "\n";
+        report << "Cells: % of room time booked (Scheduled) / actually used (Used), hours "
+            << FIRST_HOUR << ":00-" << LAST_HOUR << ":00; room totals cover Mon-Sat.\n\n";
+
+        vector<Group*> groups{ &campus };
+        for (auto& b : buildings) {
+            const Building* building = dm.getBuildingById(b.first);
+            b.second.name = building ? building->name.str() : "Building " + to_string(b.first);
+            groups.push_back(&b.second);
+        }
 
-                if (se.isCanceled) {
-                    statusStr = "Canceled/Leave";
-                    leavesOrCancellations++;
+        for (Group* g : groups) {
+            report << "=== " << g->name << " (" << g->roomCount << " rooms) ===\n";
+            heatmap(report, "Scheduled %", g->booked, g->roomCount);
+            heatmap(report, "Used %", g->usedSlots, g->roomCount);
+
+            if (g != &campus) {
+                report << "\n" << left << setw(20) << "Room" << right << setw(10) << "Sched %" << setw(10) << "Used %"
+                    << setw(10) << "Gap %" << setw(14) << "Peak" << "\n";
+                report << string(64, '-') << "\n";
+                for (int r : g->roomPositions) {
+                    const uint32_t* s = &scheduled[(size_t)r * 7 * HOURS];
+                    const uint32_t* u = &used[(size_t)r * 7 * HOURS];
+                    unsigned long long sTotal = 0, uTotal = 0;
+                    int peak = -1, peakWeekday = 1, peakHour = 0;
+                    for (int w = 1; w <= 6; ++w) {
+                        for (int h = 0; h < HOURS; ++h) {
+                            sTotal += s[w * HOURS + h];
+                            uTotal += u[w * HOURS + h];
+                            int p = percent(s[w * HOURS + h], 1, w);
+                            if (p > peak) { peak = p; peakWeekday = w; peakHour = FIRST_HOUR + h; }
+                        }
+                    }
+                    double sPct = roomWeekSlots ? 100.0 * sTotal / roomWeekSlots : 0.0;
+                    double uPct = roomWeekSlots ? 100.0 * uTotal / roomWeekSlots : 0.0;
+                    report << left << setw(20) << rooms[r].roomName << right << fixed << setprecision(1)
+                        << setw(10) << sPct << setw(10) << uPct << setw(10) << sPct - uPct
+                        << setw(8) << Date(1, 1, 2024, peakWeekday).getWeekdayString().substr(0, 3)
+                        << " " << setw(2) << setfill('0') << peakHour << setfill(' ') << ":00\n";
                 }
-                else if (se.status == 1) {
-                    statusStr = "Completed";
-                    actStart = se.actualStart.toString();
-                    actEnd = se.actualEnd.toString();
-                    durationStr = std::to_string(duration);
+            }
+            report << "\n";
+        }
+
+        // capacity planning: campus cells close to full, and the least booked rooms
+        report << "--- CAPACITY PLANNING ---\n";
+        report << "Hours with at least 85% of rooms booked:\n";
+        bool anySaturated = false;
+        for (int w = 0; w < 7; ++w) {
+            for (int h = 0; h < HOURS; ++h) {
+                int p = percent(campus.booked[w * HOURS + h], campus.roomCount, w);
+                if (p >= 85) {
+                    report << "  " << Date(1, 1, 2024, w).getWeekdayString() << " " << setw(2) << setfill('0')
+                        << FIRST_HOUR + h << setfill(' ') << ":00  " << p << "%\n";
+                    anySaturated = true;
                 }
-                else {
-                    statusStr = "Scheduled";
+            }
+        }
+        if (!anySaturated) report << "  none\n";
+
+        vector<pair<unsigned long long, int>> byBooking;
+        for (size_t r = 0; r < rooms.size() && r < dm.getOccupancy().rooms(); ++r) {
+            unsigned long long total = 0;
+            for (int c = 7 * HOURS - 1; c >= HOURS; --c) total += scheduled[r * 7 * HOURS + c]; // Mon-Sat
+            byBooking.push_back(make_pair(total, (int)r));
+        }
+        sort(byBooking.begin(), byBooking.end());
+        report << "\nLeast booked rooms (candidates for consolidation):\n";
+        for (size_t i = 0; i < byBooking.size() && i < 10; ++i) {
+            const Room& room = rooms[byBooking[i].second];
+            report << "  " << left << setw(20) << room.roomName << setw(25) << getRoomInfo(room.roomId) << right << fixed
+                << setprecision(1) << (roomWeekSlots ? 100.0 * byBooking[i].first / roomWeekSlots : 0.0) << "%\n";
+        }
+        formatPhase.end();
+
+        storeReport(key, versions, "RoomUtilizationReport", report.str());
+    }
+
+    // Per-person workload over [from, to]: instructors through LabSection::instructorId, TAs through
+    // taIds. Schedules are split into partitions reduced on separate threads into per-person
+    // accumulators, which are then summed; nothing is scanned per person or per section.
+    void generateWorkloadReport(const Date& from, const Date& to) const {
+        TraceSpan span("report.workload");
+        ScopedTimer timer(SystemStats::instance().operation("report.workload"));
+        string key = "workload " + from.toString() + " " + to.toString();
+        vector<uint64_t> versions = allVersions();
+        if (reuseReport(key, versions)) return;
+        const int fromDay = from.toDayNumber(), toDay = to.toDayNumber();
+        const int fromKey = from.toKey(), toKey = to.toKey();
+        const int weeks = (toDay - fromDay) / 7 + 1;
+
+        // dense person slots and, per section, the slots it charges
+        TraceSpan groupPhase("report.workload.group");
+        const auto& sections = dm.getLabSections();
+        vector<int> personIds;
+        unordered_map<int, int> personSlot;
+        vector<int> sectionCount;
+        auto slotOf = [&](int personId) {
+            auto it = personSlot.find(personId);
+            if (it != personSlot.end()) return it->second;
+            personSlot[personId] = (int)personIds.size();
+            personIds.push_back(personId);
+            sectionCount.push_back(0);
+            return (int)personIds.size() - 1;
+        };
+        unordered_map<int, SmallVector<int, LabSection::MAX_TAS + 1>> chargedSlots; // instructor + TAs
+        for (const auto& ls : sections) {
+            auto& slots = chargedSlots[ls.sectionId];
+            if (ls.instructorId) slots.push_back(slotOf(ls.instructorId));
+            for (int taId : ls.taIds) slots.push_back(slotOf(taId));
+            for (int s : slots) sectionCount[s]++;
+        }
+        groupPhase.end();
+
+        struct Workload {
+            int sessions = 0, completed = 0, canceled = 0, makeups = 0;
+            long long scheduledMinutes = 0, contactMinutes = 0; // integer so the reduction order does not matter
+        };
+        struct Partial {
+            vector<Workload> totals;
+            vector<long long> weekly; // [slot * weeks + week] delivered contact minutes
+        };
+
+        TraceSpan reducePhase("report.workload.reduce");
+        // the active schedules, then the archived pages in the period streamed through the history
+        // cache; each partition takes its share of the active columns and every partitions-th page
+        size_t total = dm.getSchedules().size() + dm.archivedSessionsBetween(fromKey, toKey);
+        const size_t PARTITION_MIN = 20000; // smaller inputs are not worth a thread
+        unsigned partitions = (unsigned)min<size_t>(max(1u, thread::hardware_concurrency()), total / PARTITION_MIN + 1);
+        vector<Partial> partials(partitions);
+        auto reduce = [&](unsigned p) {
+            Partial& out = partials[p];
+            out.totals.assign(personIds.size(), Workload());
+            out.weekly.assign(personIds.size() * weeks, 0);
+            auto charge = [&](int key, int sectionId, long long planned, bool canceled, bool completed, bool makeup,
+                const Time& actualStart, const Time& actualEnd) {
+                if (key < fromKey || key > toKey) return;
+                auto it = chargedSlots.find(sectionId);
+                if (it == chargedSlots.end()) return;
+                long long delivered = 0;
+                int week = 0;
+                if (completed) {
+                    delivered = llround(actualStart.calculateDurationHours(actualEnd) * 60);
+                    week = (Date::fromKey(key).toDayNumber() - fromDay) / 7;
+                }
+                for (int s : it->second) {
+                    Workload& w = out.totals[s];
+                    w.sessions++;
+                    w.scheduledMinutes += planned;
+                    if (makeup) w.makeups++;
+                    if (canceled) w.canceled++;
+                    else if (completed) {
+                        w.completed++;
+                        w.contactMinutes += delivered;
+                        out.weekly[(size_t)s * weeks + week] += delivered;
+                    }
+                }
+            };
+            const ScheduleStore& schedules = dm.getSchedules();
+            size_t begin = schedules.size() * p / partitions, end = schedules.size() * (p + 1) / partitions;
+            for (size_t i = begin; i < end; ++i) {
+                // hot columns only, except for the makeup flag and actual times of completed sessions
+                int key = schedules.dateKey(i);
+                if (key < fromKey || key > toKey) continue;
+                bool canceled = schedules.isCanceled(i);
+                bool completed = !canceled && schedules.status(i) == 1;
+                charge(key, schedules.sectionId(i), schedules.endMinute(i) - schedules.startMinute(i), canceled, completed,
+                    schedules.isMakeup(i), completed ? schedules.actualStart(i) : Time(), completed ? schedules.actualEnd(i) : Time());
+            }
+            auto minuteOf = [](const Time& t) { return (long long)t.getHour() * 60 + t.getMinute(); };
+            dm.forEachArchivedSessionPage(fromKey, toKey, partitions, p, [&](const HistoryPage& page) {
+                for (const auto& se : page.sessions) {
+                    bool completed = !se.isCanceled && se.status == 1;
+                    charge(se.scheduledDate.toKey(), se.sectionId, minuteOf(se.expectedEnd) - minuteOf(se.expectedStart),
+                        se.isCanceled, completed, se.isMakeup, se.actualStart, se.actualEnd);
+                }
+            });
+        };
+        vector<thread> workers;
+        for (unsigned p = 1; p < partitions; ++p) workers.emplace_back(reduce, p);
+        reduce(0);
+        for (auto& w : workers) w.join();
+
+        Partial merged = move(partials[0]);
+        for (unsigned p = 1; p < partitions; ++p) {
+            for (size_t s = 0; s < personIds.size(); ++s) {
+                Workload& w = merged.totals[s];
+                const Workload& o = partials[p].totals[s];
+                w.sessions += o.sessions; w.completed += o.completed; w.canceled += o.canceled; w.makeups += o.makeups;
+                w.scheduledMinutes += o.scheduledMinutes; w.contactMinutes += o.contactMinutes;
+            }
+            for (size_t c = 0; c < merged.weekly.size(); ++c) merged.weekly[c] += partials[p].weekly[c];
+        }
+
+        // makeup requests raised by each instructor in the period
+        vector<int> requested(personIds.size(), 0), approved(personIds.size(), 0);
+        dm.forEachRequestBetween(fromKey, toKey, [&](const MakeupRequest& r) {
+            auto it = personSlot.find(r.instructorId);
+            if (it == personSlot.end()) return;
+            requested[it->second]++;
+            if (r.status == 1) approved[it->second]++;
+        });
+        reducePhase.end();
+
+        TraceSpan formatPhase("report.workload.format");
+        stringstream report;
+        report << "--- INSTRUCTOR & TA WORKLOAD REPORT ---\n";
+        report << "Period: " << from.toString() << " to " << to.toString() << " (" << weeks << " weeks)\n";
+        report << "Generated on: " << reportDate() << "\n\n";
+
+        vector<int> order(personIds.size());
+        for (size_t s = 0; s < order.size(); ++s) order[s] = (int)s;
+        sort(order.begin(), order.end(), [&](int a, int b) { return personIds[a] < personIds[b]; });
+
+        for (Role role : { Role::Instructor, Role::TA }) {
+            report << "=== " << role << "s ===\n";
+            report << left << setw(8) << "ID" << setw(25) << "Name" << right << setw(9) << "Sections" << setw(10) << "Sessions"
+                << setw(11) << "Completed" << setw(11) << "Sched Hrs" << setw(13) << "Contact Hrs" << setw(9) << "Makeups"
+                << setw(10) << "Canceled" << setw(10) << "Cancel %";
+            if (role == Role::Instructor) report << setw(11) << "Requests" << setw(10) << "Approved";
+            report << "\n" << string(role == Role::Instructor ? 137 : 116, '-') << "\n";
+
+            bool any = false;
+            for (int s : order) {
+                const Person* p = dm.getPersonById(personIds[s]);
+                if (!p || p->role != role) continue;
+                any = true;
+                const Workload& w = merged.totals[s];
+                report << left << setw(8) << personIds[s] << setw(25) << p->getName() << right << setw(9) << sectionCount[s]
+                    << setw(10) << w.sessions << setw(11) << w.completed << fixed << setprecision(2)
+                    << setw(11) << w.scheduledMinutes / 60.0 << setw(13) << w.contactMinutes / 60.0 << setw(9) << w.makeups << setw(10) << w.canceled
+                    << setprecision(1) << setw(10) << (w.sessions ? 100.0 * w.canceled / w.sessions : 0.0);
+                if (role == Role::Instructor) report << setw(11) << requested[s] << setw(10) << approved[s];
+                report << "\n";
+            }
+            if (!any) report << "None assigned.\n";
+            report << "\n";
+        }
+
+        report << "--- WEEKLY CONTACT HOURS ---\n";
+        report << left << setw(25) << "Name";
+        for (int wk = 0; wk < weeks; ++wk) report << right << setw(7) << "W" + to_string(wk + 1);
+        report << "\n";
+        for (int s : order) {
+            const Person* p = dm.getPersonById(personIds[s]);
+            if (!p || merged.totals[s].sessions == 0) continue;
+            report << left << setw(25) << p->getName().substr(0, 24) << right << fixed << setprecision(1);
+            for (int wk = 0; wk < weeks; ++wk) report << setw(7) << merged.weekly[(size_t)s * weeks + wk] / 60.0;
+            report << "\n";
+        }
+        report << "(W1 starts " << from.toString() << ")\n";
+        formatPhase.end();
+
+        storeReport(key, versions, "WorkloadReport", report.str());
+    }
+};
+
+// bulk import
+
+// Non-interactive CSV importer for onboarding a semester. Each file has a header line and
+// refers to other rows by its own "key" column (an existing numeric ID also resolves):
+//   persons.csv    key,name,role,password
+//   buildings.csv  key,name,address,attendant_key
+//   rooms.csv      key,building_key,room_name
+//   sections.csv   key,course_code,course_name,section_name,instructor_key,ta_keys (';' separated)
+//   schedules.csv  section_key,room_key,date (DD/MM/YYYY),start (HH:MM),end (HH:MM),makeup (0/1)
+// Files are split into chunks parsed on separate threads; rows are then resolved in file
+// order and every .dat file is written once at the end. Quoted fields may not span lines.
+class CsvImporter {
+private:
+    DataManager& dm;
+    unsigned threadCount;
+
+    unordered_map<string, int> personKeys;
+    unordered_map<string, int> buildingKeys;
+    unordered_map<string, int> roomKeys;
+    unordered_map<string, int> sectionKeys;
+
+    struct CsvRow {
+        int line;
+        vector<string> fields;
+    };
+
+    struct TableStats {
+        size_t rows = 0;
+        size_t imported = 0;
+        size_t rejected = 0;
+        double seconds = 0.0;
+    };
+
+    static void splitCsvLine(const string& text, size_t begin, size_t end, vector<string>& fields) {
+        fields.clear();
+        string field;
+        bool quoted = false;
+        for (size_t i = begin; i < end; ++i) {
+            char c = text[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < end && text[i + 1] == '"') { field += '"'; ++i; }
+                else if (c == '"') quoted = false;
+                else field += c;
+            }
+            else if (c == '"') quoted = true;
+            else if (c == ',') { fields.push_back(field); field.clear(); }
+            else if (c != '\r') field += c;
+        }
+        fields.push_back(field);
+        for (auto& f : fields) {
+            size_t b = f.find_first_not_of(" \t");
+            size_t e = f.find_last_not_of(" \t");
+            f = (b == string::npos) ? "" : f.substr(b, e - b + 1);
+        }
+    }
+
+    // parses [begin, end) of text, which starts on a line boundary
+    static void parseChunk(const string& text, size_t begin, size_t end, int firstLine, vector<CsvRow>& out) {
+        int line = firstLine;
+        while (begin < end) {
+            size_t eol = text.find('\n', begin);
+            if (eol == string::npos || eol > end) eol = end;
+            if (eol > begin && !(eol == begin + 1 && text[begin] == '\r')) {
+                CsvRow row;
+                row.line = line;
+                splitCsvLine(text, begin, eol, row.fields);
+                out.push_back(row);
+            }
+            begin = eol + 1;
+            line++;
+        }
+    }
+
+    // reads a whole CSV file (minus its header) using one chunk per thread
+    bool parseFile(const string& path, vector<CsvRow>& rows) {
+        ifstream ifs(path, ios::binary);
+        if (!ifs) return false;
+        stringstream buffer;
+        buffer << ifs.rdbuf();
+        string text = buffer.str();
+
+        size_t start = text.find('\n');
+        if (start == string::npos) return true; // header only
+        start++;
+
+        // chunk boundaries on line breaks, with the line number each chunk starts at
+        vector<size_t> bounds{ start };
+        size_t target = (text.size() - start) / threadCount + 1;
+        for (unsigned t = 1; t < threadCount; ++t) {
+            size_t pos = text.find('\n', bounds.back() + target);
+            if (pos == string::npos || pos + 1 >= text.size()) break;
+            bounds.push_back(pos + 1);
+        }
+        bounds.push_back(text.size());
+
+        size_t chunks = bounds.size() - 1;
+        vector<int> firstLines(chunks, 2);
+        for (size_t c = 1; c < chunks; ++c) {
+            firstLines[c] = firstLines[c - 1] + (int)count(text.begin() + bounds[c - 1], text.begin() + bounds[c], '\n');
+        }
+
+        vector<vector<CsvRow>> parts(chunks);
+        vector<thread> workers;
+        for (size_t c = 0; c < chunks; ++c) {
+            workers.emplace_back(parseChunk, cref(text), bounds[c], bounds[c + 1], firstLines[c], ref(parts[c]));
+        }
+        for (auto& w : workers) w.join();
+
+        for (auto& part : parts) {
+            rows.insert(rows.end(), make_move_iterator(part.begin()), make_move_iterator(part.end()));
+        }
+        return true;
+    }
+
+    // key from this import first, then an existing ID already in the system
+    int resolve(const unordered_map<string, int>& keys, const string& key, bool existsById) const {
+        auto it = keys.find(key);
+        if (it != keys.end()) return it->second;
+        if (existsById) return atoi(key.c_str());
+        return 0;
+    }
+
+    static bool isNumber(const string& s) {
+        return !s.empty() && all_of(s.begin(), s.end(), [](char c) { return isdigit((unsigned char)c); });
+    }
+
+    int resolvePerson(const string& key, Role role) const {
+        int id = resolve(personKeys, key, isNumber(key) && dm.getPersonById(atoi(key.c_str())));
+        const Person* p = id ? dm.getPersonById(id) : nullptr;
+        return (p && p->role == role) ? id : 0;
+    }
+    int resolveBuilding(const string& key) const {
+        return resolve(buildingKeys, key, isNumber(key) && dm.getBuildingById(atoi(key.c_str())));
+    }
+    int resolveRoom(const string& key) const {
+        return resolve(roomKeys, key, isNumber(key) && dm.getRoomById(atoi(key.c_str())));
+    }
+    int resolveSection(const string& key) const {
+        return resolve(sectionKeys, key, isNumber(key) && dm.getLabSectionById(atoi(key.c_str())));
+    }
+
+    void reject(TableStats& st, const string& file, int line, const string& why) {
+        st.rejected++;
+        cout << "  [SKIPPED] " << file << ":" << line << ": " << why << "\n";
+    }
+
+    // each loader: parse in parallel, then resolve/insert rows in file order
+    template <typename Fn>
+    bool importTable(const string& dir, const string& file, size_t minFields, TableStats& st, Fn insertRow) {
+        auto begin = chrono::steady_clock::now();
+        vector<CsvRow> rows;
+        if (!parseFile(dir + "/" + file, rows)) return false;
+        st.rows = rows.size();
+        for (const auto& row : rows) {
+            if (row.fields.size() < minFields) {
+                reject(st, file, row.line, "expected " + to_string(minFields) + " columns");
+                continue;
+            }
+            string why = insertRow(row.fields);
+            if (why.empty()) st.imported++;
+            else reject(st, file, row.line, why);
+        }
+        st.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        return true;
+    }
+
+    string insertPerson(const vector<string>& f) {
+        Role role = parseRole(f[2]);
+        if (role == Role::None) return "invalid role '" + f[2] + "'";
+        if (personKeys.count(f[0])) return "duplicate key '" + f[0] + "'";
+        personKeys[f[0]] = dm.addPerson(f[1], role, f[3].empty() ? "pass" : f[3]);
+        return "";
+    }
+
+    string insertBuilding(const vector<string>& f) {
+        int attendantId = resolvePerson(f[3], Role::Attendant);
+        if (!attendantId) return "unknown attendant '" + f[3] + "'";
+        if (buildingKeys.count(f[0])) return "duplicate key '" + f[0] + "'";
+        buildingKeys[f[0]] = dm.addBuilding(f[1], f[2], attendantId);
+        return "";
+    }
+
+    string insertRoom(const vector<string>& f) {
+        int buildingId = resolveBuilding(f[1]);
+        if (!buildingId) return "unknown building '" + f[1] + "'";
+        if (roomKeys.count(f[0])) return "duplicate key '" + f[0] + "'";
+        roomKeys[f[0]] = dm.addRoom(f[2], buildingId);
+        return "";
+    }
+
+    // every key on the row is resolved before anything is created, so a row is either imported
+    // whole or not at all
+    string insertSection(const vector<string>& f, unordered_map<string, int>& existingSections) {
+        if (sectionKeys.count(f[0])) return "duplicate key '" + f[0] + "'";
+        const string& code = f[1];
+
+        int insId = 0;
+        if (f.size() > 4 && !f[4].empty()) {
+            insId = resolvePerson(f[4], Role::Instructor);
+            if (!insId) return "unknown instructor '" + f[4] + "'";
+        }
+        vector<int> taIds;
+        if (f.size() > 5 && !f[5].empty()) {
+            stringstream taList(f[5]);
+            string taKey;
+            while (getline(taList, taKey, ';')) {
+                int taId = resolvePerson(taKey, Role::TA);
+                if (!taId) return "unknown TA '" + taKey + "'";
+                if (find(taIds.begin(), taIds.end(), taId) == taIds.end()) taIds.push_back(taId);
+            }
+        }
+
+        auto existing = existingSections.find(code + "-" + f[3]);
+        const LabSection* current = existing != existingSections.end() ? dm.getLabSectionById(existing->second) : nullptr;
+        size_t taCount = current ? current->taIds.size() : 0;
+        for (int taId : taIds) {
+            if (!current || find(current->taIds.begin(), current->taIds.end(), taId) == current->taIds.end()) taCount++;
+        }
+        if (taCount > LabSection::MAX_TAS) return "more than " + to_string(LabSection::MAX_TAS) + " TAs";
+
+        int sectionId = 0;
+        if (existing != existingSections.end()) {
+            sectionId = existing->second;
+        }
+        else {
+            const Course* course = dm.getCourseByCode(code);
+            int courseId = course ? course->courseId : dm.addCourse(code, f[2]);
+            sectionId = dm.addLabSection(courseId, f[3]);
+            existingSections[code + "-" + f[3]] = sectionId;
+        }
+        sectionKeys[f[0]] = sectionId;
+
+        if (insId) dm.assignInstructor(sectionId, insId);
+        for (int taId : taIds) dm.assignTA(sectionId, taId); // already listed TAs are skipped
+        return "";
+    }
+
+    // conflicts are checked against existing sessions and rows already accepted in this import
+    string insertSchedule(const vector<string>& f) {
+        int sectionId = resolveSection(f[0]);
+        if (!sectionId) return "unknown section '" + f[0] + "'";
+        int roomId = resolveRoom(f[1]);
+        if (!roomId) return "unknown room '" + f[1] + "'";
+        Date date;
+        Time start, end;
+        if (!Date::parse(f[2], date)) return "bad date '" + f[2] + "'";
+        if (!Time::parse(f[3], start) || !Time::parse(f[4], end)) return "bad time";
+        if (!(start < end)) return "end time is not after start time";
+        const Holiday* holiday = dm.getHoliday(date, sectionId, roomId);
+        if (holiday) return date.toString() + " is a holiday (" + holiday->description + ")";
+        if (!dm.isRoomAvailable(roomId, date, start, end)) return "room " + f[1] + " is already booked on " + f[2];
+        bool makeup = f.size() > 5 && f[5] == "1";
+        dm.addScheduleEntry(sectionId, roomId, date, start, end, makeup);
+        return "";
+    }
+
+    static void printStats(const string& table, const TableStats& st) {
+        double rate = st.seconds > 0 ? st.rows / st.seconds : 0.0;
+        cout << left << setw(12) << table << setw(10) << st.rows << setw(10) << st.imported << setw(10) << st.rejected
+            << setw(12) << fixed << setprecision(1) << st.seconds * 1000.0 << setprecision(0) << rate << endl;
+    }
+
+public:
+    CsvImporter(DataManager& dataManager, unsigned threads = 0) : dm(dataManager) {
+        threadCount = threads ? threads : max(1u, thread::hardware_concurrency());
+    }
+
+    // Imports whichever of the five CSV files exist in dir. Returns false if nothing could be saved.
+    bool importDirectory(const string& dir) {
+        auto begin = chrono::steady_clock::now();
+        TableStats persons, buildings, rooms, sections, schedules;
+
+        unordered_map<string, int> existingSections;
+        for (const auto& ls : dm.getLabSections()) {
+            existingSections[dm.getFullSectionCode(ls)] = ls.sectionId;
+        }
+
+        cout << "Importing from " << dir << " using " << threadCount << " parser thread(s)...\n";
+        dm.beginBatch();
+        importTable(dir, "persons.csv", 4, persons, [&](const vector<string>& f) { return insertPerson(f); });
+        importTable(dir, "buildings.csv", 4, buildings, [&](const vector<string>& f) { return insertBuilding(f); });
+        importTable(dir, "rooms.csv", 3, rooms, [&](const vector<string>& f) { return insertRoom(f); });
+        importTable(dir, "sections.csv", 4, sections, [&](const vector<string>& f) { return insertSection(f, existingSections); });
+        importTable(dir, "schedules.csv", 5, schedules, [&](const vector<string>& f) { return insertSchedule(f); });
+
+        auto writeBegin = chrono::steady_clock::now();
+        bool saved = dm.commitBatch();
+        double writeSeconds = chrono::duration<double>(chrono::steady_clock::now() - writeBegin).count();
+        double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        size_t totalRows = persons.rows + buildings.rows + rooms.rows + sections.rows + schedules.rows;
+
+        cout << "\n--- IMPORT SUMMARY ---\n";
+        cout << left << setw(12) << "Table" << setw(10) << "Rows" << setw(10) << "Imported" << setw(10) << "Skipped"
+            << setw(12) << "Time (ms)" << "Rows/s" << endl;
+        cout << string(64, '-') << endl;
+        printStats("Persons", persons);
+        printStats("Buildings", buildings);
+        printStats("Rooms", rooms);
+        printStats("Sections", sections);
+        printStats("Schedules", schedules);
+        cout << "Write time: " << fixed << setprecision(1) << writeSeconds * 1000.0 << " ms\n";
+        cout << "Total: " << totalRows << " rows in " << setprecision(1) << totalSeconds * 1000.0 << " ms ("
+            << setprecision(0) << (totalSeconds > 0 ? totalRows / totalSeconds : 0.0) << " rows/s)\n";
+
+        if (!saved) cout << "[ERROR] Some data files could not be written.\n";
+        return saved;
+    }
+};
+
+// scripted batch mode
+
+// Runs a command file without menu prompts, e.g. for nightly report batches or load tests.
+// One command per line, '#' starts a comment:
+//   login <id> <password>                        authenticate; later commands run as this user
+//   report schedule | report timesheet <label> | report summary <sectionId>      (HoD)
+//   report utilization <DD/MM/YYYY> <DD/MM/YYYY>                                 (HoD)
+//   report workload <DD/MM/YYYY> <DD/MM/YYYY>                                    (HoD)
+//   timesheet <scheduleId> <HH:MM> <HH:MM>                                       (Attendant)
+//   request <sectionId> <DD/MM/YYYY> <HH:MM> <HH:MM> <reason...>                 (Instructor)
+//   approve <requestId> <roomId> | disapprove <requestId>                        (AcademicOfficer)
+//   cancel <DD/MM/YYYY> <DD/MM/YYYY> [building=ID] [section=ID] [instructor=ID]  (AcademicOfficer)
+//   holiday <DD/MM/YYYY> <DD/MM/YYYY> [building=ID] [section=ID] [instructor=ID] <description...>
+//                                                  records the holiday and cancels what it covers (AcademicOfficer)
+//   archive <DD/MM/YYYY>                           archive semesters that ended before this date's (AcademicOfficer)
+//   stats [file]                                   JSON statistics snapshot (HoD, AcademicOfficer)
+//   logout
+// All changes are batched and each touched .dat file is written once when the script ends.
+// On a read replica only login, logout, report and stats are accepted.
+class ScriptRunner {
+private:
+    DataManager& dm;
+    Authentication auth;
+    HoDReportGenerator reporter;
+    const Person* user = nullptr;
+    mutex* replicaLock = nullptr; // held around each command on a replica (see ReplicaFollower)
+
+    static string restOf(stringstream& ss) {
+        string rest;
+        getline(ss, rest);
+        size_t b = rest.find_first_not_of(" \t");
+        return b == string::npos ? "" : rest.substr(b);
+    }
+
+    bool requireRole(Role role, string& error) const {
+        if (!user) { error = "not logged in"; return false; }
+        if (user->role != role) { error = string("requires role ") + roleName(role); return false; }
+        return true;
+    }
+
+    // returns an empty string on success, otherwise the reason the command failed
+    string execute(const string& cmd, stringstream& args) {
+        string error;
+        if (replicaLock && cmd != "login" && cmd != "logout" && cmd != "report" && cmd != "stats") {
+            return "not allowed on a read-only replica";
+        }
+        if (cmd == "login") {
+            long long id = 0;
+            string pass;
+            args >> id >> pass;
+            user = auth.authenticate(id, pass);
+            return user ? "" : "invalid user ID or password";
+        }
+        if (cmd == "logout") {
+            user = nullptr;
+            return "";
+        }
+        if (cmd == "stats") {
+            if (!user || (user->role != Role::HoD && user->role != Role::AcademicOfficer)) return "requires role HoD or AcademicOfficer";
+            string path;
+            args >> path;
+            if (path.empty()) path = "system_stats.json";
+            return SystemStats::instance().dump(path) ? "" : "could not write " + path;
+        }
+        if (cmd == "report") {
+            if (!requireRole(Role::HoD, error)) return error;
+            string type;
+            args >> type;
+            if (type == "schedule") reporter.generateLabScheduleReport();
+            else if (type == "timesheet") reporter.generateTimeSheetReport(restOf(args));
+            else if (type == "utilization") {
+                string fromText, toText;
+                Date from, to;
+                args >> fromText >> toText;
+                if (!Date::parse(fromText, from) || !Date::parse(toText, to) || to < from) return "bad date range";
+                reporter.generateRoomUtilizationReport(from, to);
+            }
+            else if (type == "workload") {
+                string fromText, toText;
+                Date from, to;
+                args >> fromText >> toText;
+                if (!Date::parse(fromText, from) || !Date::parse(toText, to) || to < from) return "bad date range";
+                reporter.generateWorkloadReport(from, to);
+            }
+            else if (type == "summary") {
+                int secId = 0;
+                args >> secId;
+                if (!dm.getLabSectionById(secId)) return "invalid lab section ID";
+                reporter.generateLabSummaryReport(secId);
+            }
+            else return "unknown report '" + type + "'";
+            return "";
+        }
+        if (cmd == "timesheet") {
+            if (!requireRole(Role::Attendant, error)) return error;
+            int schId = 0;
+            string startText, endText;
+            Time start, end;
+            args >> schId >> startText >> endText;
+            if (!Time::parse(startText, start) || !Time::parse(endText, end)) return "bad time";
+            if (start > end) return "actual end time is before actual start time";
+
+            ScheduleEntry entry;
+            if (!dm.getScheduleById(schId, entry) || entry.status != 0) return "schedule ID not found or not pending";
+            const Room* room = dm.getRoomById(entry.roomId);
+            const Building* building = room ? dm.getBuildingById(room->buildingId) : nullptr;
+            if (!building || building->attendantId != user->personId) return "session is not in your rooms";
+            return dm.updateScheduleActualTime(schId, start, end) ? "" : "update failed";
+        }
+        if (cmd == "request") {
+            if (!requireRole(Role::Instructor, error)) return error;
+            int secId = 0;
+            string dateText, startText, endText;
+            Date date;
+            Time start, end;
+            args >> secId >> dateText >> startText >> endText;
+            const LabSection* ls = dm.getLabSectionById(secId);
+            if (!ls || ls->instructorId != user->personId) return "section not assigned to you";
+            if (!Date::parse(dateText, date)) return "bad date";
+            if (!Time::parse(startText, start) || !Time::parse(endText, end)) return "bad time";
+            dm.addMakeupRequest(secId, user->personId, date, start, end, restOf(args));
+            return "";
+        }
+        if (cmd == "approve" || cmd == "disapprove") {
+            if (!requireRole(Role::AcademicOfficer, error)) return error;
+            int reqId = 0, roomId = 0;
+            args >> reqId >> roomId;
+            const MakeupRequest* req = nullptr;
+            for (const auto& mr : dm.getRequests()) {
+                if (mr.requestId == reqId) { req = &mr; break; }
+            }
+            if (!req || req->status != 0) return "request not found or not pending";
+            if (cmd == "disapprove") return dm.updateMakeupRequestStatus(reqId, 2) ? "" : "update failed";
+
+            if (!dm.getRoomById(roomId)) return "invalid room ID";
+            const Holiday* holiday = dm.getHoliday(req->requestedDate, req->sectionId, roomId);
+            if (holiday) return req->requestedDate.toString() + " is a holiday (" + holiday->description + ")";
+            if (!dm.isRoomAvailable(roomId, req->requestedDate, req->requestedStart, req->requestedEnd)) return "room not available";
+            MakeupRequest approved = *req;
+            dm.updateMakeupRequestStatus(reqId, 1);
+            dm.addScheduleEntry(approved.sectionId, roomId, approved.requestedDate, approved.requestedStart, approved.requestedEnd, true);
+            return "";
+        }
+        if (cmd == "archive") {
+            if (!requireRole(Role::AcademicOfficer, error)) return error;
+            string cutoffText;
+            Date cutoff;
+            args >> cutoffText;
+            if (!Date::parse(cutoffText, cutoff)) return "bad date";
+            int moved = dm.archiveSemestersBefore(cutoff);
+            if (moved < 0) return "archive failed";
+            cout << "Archived " << moved << " sessions from semesters before " << ArchivedSemester::name(ArchivedSemester::of(cutoff.toKey())) << "." << endl;
+            return "";
+        }
+        if (cmd == "cancel" || cmd == "holiday") {
+            if (!requireRole(Role::AcademicOfficer, error)) return error;
+            string fromText, toText;
+            Date from, to;
+            args >> fromText >> toText;
+            if (!Date::parse(fromText, from) || !Date::parse(toText, to)) return "bad date";
+            if (to < from) return "last day is before first day";
+
+            // cancel takes only filters; holiday takes filters first, then its description
+            int bId = 0, secId = 0, insId = 0;
+            string filter;
+            streampos mark = args.tellg();
+            while (args >> filter) {
+                size_t eq = filter.find('=');
+                string key = filter.substr(0, eq);
+                // 0 would mean "all", so a filter needs a positive id
+                int value = 0;
+                if (key == "building" || key == "section" || key == "instructor") {
+                    char* endPtr = nullptr;
+                    long parsed = eq == string::npos ? 0 : strtol(filter.c_str() + eq + 1, &endPtr, 10);
+                    if (eq == string::npos || *endPtr != '\0' || parsed <= 0 || parsed > numeric_limits<int>::max()) return "bad filter '" + filter + "'";
+                    value = (int)parsed;
+                }
+                if (key == "building") bId = value;
+                else if (key == "section") secId = value;
+                else if (key == "instructor") insId = value;
+                else if (cmd == "holiday") {
+                    args.clear();
+                    args.seekg(mark);
+                    break;
+                }
+                else return "unknown filter '" + filter + "'";
+                mark = args.tellg();
+            }
+            if (bId != 0 && !dm.getBuildingById(bId)) return "invalid building ID";
+            if (secId != 0 && !dm.getLabSectionById(secId)) return "invalid section ID";
+            if (insId != 0) {
+                const Person* ins = dm.getPersonById(insId);
+                if (!ins || ins->role != Role::Instructor) return "invalid instructor ID";
+            }
+            if (cmd == "holiday") dm.addHoliday(from, to, restOf(args), bId, secId, insId);
+            return dm.cancelSchedules(from, to, bId, secId, insId) >= 0 ? "" : "save failed";
+        }
+        return "unknown command '" + cmd + "'";
+    }
+
+public:
+    ScriptRunner(DataManager& dataManager) : dm(dataManager), auth(dataManager), reporter(dataManager) {}
+
+    // read-only from now on, each command running under applyLock
+    void setReplica(mutex& applyLock) { replicaLock = &applyLock; }
+
+    // Executes every command in the stream; returns the number of failed commands.
+    int run(istream& script, const string& name) {
+        auto begin = chrono::steady_clock::now();
+        int lineNo = 0, executed = 0, failed = 0;
+        string line;
+
+        dm.beginBatch();
+        while (getline(script, line)) {
+            lineNo++;
+            size_t hash = line.find('#');
+            if (hash != string::npos) line.erase(hash);
+            stringstream args(line);
+            string cmd;
+            if (!(args >> cmd)) continue;
+
+            executed++;
+            unique_lock<mutex> guard;
+            if (replicaLock) guard = unique_lock<mutex>(*replicaLock);
+            string error = execute(cmd, args);
+            if (!error.empty()) {
+                failed++;
+                cout << "[ERROR] " << name << ":" << lineNo << ": " << cmd << ": " << error << endl;
+            }
+        }
+        if (!dm.commitBatch()) {
+            cout << "[ERROR] Some data files could not be written.\n";
+            failed++;
+        }
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        cout << "Script " << name << ": " << executed << " commands, " << failed << " failed, "
+            << fixed << setprecision(1) << seconds * 1000.0 << " ms\n";
+        return failed;
+    }
+};
+
+// read replicas
+
+// Keeps a DataManager over an in-memory copy of another data directory (the primary) current by
+// tailing the primary's change log, so reports can run in a separate process from the writers.
+// Changes are applied while holding lock; readers of the DataManager hold it too.
+class ReplicaFollower {
+private:
+    StorageEngine& primary;
+    DataManager& dm;
+    ChangeCursor cursor;
+    thread poller;
+    bool stopping = false;
+    mutex stopLock;
+    condition_variable stopSignal;
+
+public:
+    mutex lock;
+
+    // Copies the primary's .dat files into local and returns the log position they reflect. The
+    // primary replaces a file by renaming a finished copy over it, so each file read is whole. The
+    // copy is retried while events keep arriving; events are idempotent, so any that are already
+    // in the copied files apply harmlessly.
+    static ChangeCursor snapshot(StorageEngine& from, StorageEngine& local) {
+        ChangeCursor start;
+        string bytes;
+        for (int attempt = 0; attempt < 5; ++attempt) {
+            start = ChangeLog::end(from);
+            for (const auto& name : from.list()) {
+                if (name.size() < 4 || name.compare(name.size() - 4, 4, ".dat") != 0) continue;
+                if (from.read(name, bytes)) local.write(name, bytes.data(), bytes.size());
+            }
+            if (ChangeLog::end(from).sequence == start.sequence) break;
+        }
+        return start;
+    }
+
+    ReplicaFollower(StorageEngine& from, DataManager& replica, const ChangeCursor& start)
+        : primary(from), dm(replica), cursor(start) {}
+
+    ~ReplicaFollower() { stop(); }
+
+    // applies everything logged since the last poll; returns the number of events
+    size_t poll() {
+        vector<ChangeEvent> events;
+        size_t applied = 0;
+        while (ChangeLog::read(primary, cursor, events) > 0) {
+            lock_guard<mutex> guard(lock);
+            for (const auto& e : events) {
+                if (!dm.applyChange(e)) cout << "[ERROR] Replica could not apply change " << e.sequence << "." << endl;
+                applied++;
+            }
+            events.clear();
+        }
+        return applied;
+    }
+
+    uint64_t position() const { return cursor.sequence; }
+
+    void start(int intervalMs) {
+        poller = thread([this, intervalMs] {
+            unique_lock<mutex> guard(stopLock);
+            while (!stopSignal.wait_for(guard, chrono::milliseconds(intervalMs), [this] { return stopping; })) {
+                guard.unlock();
+                poll();
+                guard.lock();
+            }
+        });
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> guard(stopLock);
+            stopping = true;
+        }
+        stopSignal.notify_all();
+        if (poller.joinable()) poller.join();
+    }
+};
+
+// synthetic data and benchmarks
+
+// "--key value" command-line options after a subcommand
+class CommandOptions {
+private:
+    map<string, string> values;
+
+public:
+    CommandOptions(int argc, char* argv[], int first) {
+        for (int i = first; i < argc; ++i) {
+            string key = argv[i];
+            if (key.rfind("--", 0) != 0) continue;
+            key = key.substr(2);
+            if (i + 1 < argc && string(argv[i + 1]).rfind("--", 0) != 0) values[key] = argv[++i];
+            else values[key] = "1";
+        }
+    }
+
+    bool has(const string& key) const { return values.count(key) > 0; }
+    int getInt(const string& key, int def) const {
+        auto it = values.find(key);
+        return it == values.end() ? def : atoi(it->second.c_str());
+    }
+    string get(const string& key, const string& def) const {
+        auto it = values.find(key);
+        return it == values.end() ? def : it->second;
+    }
+};
+
+// Size of a generated institution. Defaults describe a mid-sized department.
+struct DatasetSpec {
+    int buildings = 10;
+    int roomsPerBuilding = 10;
+    int instructors = 80;
+    int tas = 200;
+    int sections = 400;
+    int weeks = 16;
+    int makeups = 300;
+    unsigned seed = 42;
+
+    static DatasetSpec fromOptions(const CommandOptions& opt) {
+        DatasetSpec spec;
+        spec.buildings = max(1, opt.getInt("buildings", spec.buildings));
+        spec.roomsPerBuilding = max(1, opt.getInt("rooms", spec.roomsPerBuilding));
+        spec.instructors = max(1, opt.getInt("instructors", spec.instructors));
+        spec.tas = max(1, opt.getInt("tas", spec.tas));
+        spec.sections = max(1, opt.getInt("sections", spec.sections));
+        spec.weeks = max(1, opt.getInt("weeks", spec.weeks));
+        spec.makeups = max(0, opt.getInt("makeups", spec.makeups));
+        spec.seed = (unsigned)opt.getInt("seed", (int)spec.seed);
+        return spec;
+    }
+};
+
+// Fills an empty DataManager with a realistic semester: one weekly session per section in
+// non-overlapping room slots, past weeks mostly filled in, a few cancellations and a mix of
+// pending/approved/disapproved makeup requests. Written through batch mode, one file rewrite each.
+class DatasetGenerator {
+private:
+    DataManager& dm;
+    DatasetSpec spec;
+    mt19937 rng;
+
+    int pick(int n) { return (int)(rng() % (unsigned)n); }
+
+public:
+    DatasetGenerator(DataManager& dataManager, const DatasetSpec& s) : dm(dataManager), spec(s), rng(s.seed) {}
+
+    // semester starts on Monday 05/01/2026; "today" is halfway through it
+    static Date semesterStart() { return Date(5, 1, 2026, Date::weekdayOf(5, 1, 2026)); }
+
+    void generate() {
+        const int slotsPerDay = 4; // 08:00, 11:00, 14:00, 17:00, three hours each
+        Date start = semesterStart();
+        int todayDay = start.toDayNumber() + spec.weeks * 7 / 2;
+
+        dm.beginBatch();
+        dm.addPerson("Default Academic Officer", Role::AcademicOfficer, "123");
+        dm.addPerson("Head of Department", Role::HoD, "hod");
+
+        vector<int> roomIds;
+        for (int b = 0; b < spec.buildings; ++b) {
+            int attId = dm.addPerson("Attendant " + to_string(b + 1), Role::Attendant, "pass");
+            int bId = dm.addBuilding("Block " + to_string(b + 1), "Campus Road " + to_string(b + 1), attId);
+            for (int r = 0; r < spec.roomsPerBuilding; ++r) {
+                roomIds.push_back(dm.addRoom("B" + to_string(b + 1) + "-" + to_string(100 + r), bId));
+            }
+        }
+
+        vector<int> instructorIds, taIds;
+        for (int i = 0; i < spec.instructors; ++i) instructorIds.push_back(dm.addPerson("Instructor " + to_string(i + 1), Role::Instructor, "pass"));
+        for (int i = 0; i < spec.tas; ++i) taIds.push_back(dm.addPerson("TA " + to_string(i + 1), Role::TA, "pass"));
+
+        // sections: 4 per course, round-robin staff
+        vector<int> sectionIds;
+        int courseId = 0;
+        for (int i = 0; i < spec.sections; ++i) {
+            int courseNo = i / 4 + 1;
+            if (i % 4 == 0) courseId = dm.addCourse("CS" + to_string(100 + courseNo), "Course Lab " + to_string(courseNo));
+            string sectionName(1, (char)('A' + i % 4));
+            int secId = dm.addLabSection(courseId, sectionName);
+            dm.assignInstructor(secId, instructorIds[i % instructorIds.size()]);
+            dm.assignTA(secId, taIds[(2 * i) % taIds.size()]);
+            dm.assignTA(secId, taIds[(2 * i + 1) % taIds.size()]);
+            sectionIds.push_back(secId);
+        }
+
+        // weekly sessions: section i takes slot i of the (room, weekday, time) grid
+        int capacity = (int)roomIds.size() * 5 * slotsPerDay;
+        int scheduled = min((int)sectionIds.size(), capacity);
+        if (scheduled < (int)sectionIds.size()) {
+            cout << "[WARNING] Only " << capacity << " weekly room slots; " << sectionIds.size() - scheduled << " sections left unscheduled.\n";
+        }
+        for (int w = 0; w < spec.weeks; ++w) {
+            for (int i = 0; i < scheduled; ++i) {
+                int roomId = roomIds[i % roomIds.size()];
+                int slot = i / (int)roomIds.size();
+                Date date = start.addDays(w * 7 + slot / slotsPerDay);
+                int hour = 8 + 3 * (slot % slotsPerDay);
+                int schId = dm.addScheduleEntry(sectionIds[i], roomId, date, Time(hour, 0), Time(hour + 3, 0));
+
+                if (date.toDayNumber() < todayDay) {
+                    int roll = pick(100);
+                    if (roll < 3) dm.cancelSchedules(date, date, 0, sectionIds[i]);
+                    else if (roll < 98) dm.updateScheduleActualTime(schId, Time(hour, pick(10)), Time(hour + 2, 45 + pick(15)));
+                }
+            }
+        }
+
+        // makeup requests on Saturdays, roughly 40% pending, 40% approved, 20% disapproved
+        for (int m = 0; m < spec.makeups; ++m) {
+            int secIndex = pick(scheduled > 0 ? scheduled : (int)sectionIds.size());
+            int secId = sectionIds[secIndex];
+            const LabSection* ls = dm.getLabSectionById(secId);
+            Date date = start.addDays(pick(spec.weeks) * 7 + 5);
+            int hour = 8 + 3 * pick(slotsPerDay);
+            int reqId = dm.addMakeupRequest(secId, ls->instructorId, date, Time(hour, 0), Time(hour + 3, 0), "Missed session");
+
+            int roll = pick(100);
+            if (roll < 40) continue;
+            if (roll < 80) {
+                int roomId = roomIds[pick((int)roomIds.size())];
+                if (dm.isRoomAvailable(roomId, date, Time(hour, 0), Time(hour + 3, 0))) {
+                    dm.updateMakeupRequestStatus(reqId, 1);
+                    dm.addScheduleEntry(secId, roomId, date, Time(hour, 0), Time(hour + 3, 0), true);
+                    continue;
                 }
+            }
+            dm.updateMakeupRequestStatus(reqId, 2);
+        }
+        dm.commitBatch();
+    }
+};
+
+// Times DataManager and HoDReportGenerator operations against a generated dataset.
+class BenchmarkSuite {
+private:
+    struct Result {
+        string name;
+        long long iterations;
+        double seconds;
+    };
+    vector<Result> results;
+    bool verbose;
+
+    template <typename Fn>
+    void measure(const string& name, long long iterations, Fn fn) {
+        auto begin = chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; ++i) fn(i);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        results.push_back({ name, iterations, seconds });
+        if (verbose) cerr << "  " << name << " done\n";
+    }
+
+public:
+    // verbose: report each finished operation on stderr while the suite runs
+    BenchmarkSuite(bool verboseProgress = false) : verbose(verboseProgress) {}
+
+    static long long peakRssKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return (long long)(pmc.PeakWorkingSetSize / 1024);
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    // Lookups, mutators and reports run on an in-memory copy of the data, so the data on disk and
+    // its change log are left as they were and every run starts from the same dataset.
+    void run(int scale) {
+        mt19937 rng(7);
+        long long lookups = 200000LL * scale;
+        long long rewrites = 10;
+
+        measure("loadAllData", 3, [&](long long) { DataManager fresh; });
+
+        shared_ptr<StorageEngine> copy;
+        {
+            DataManager source;
+            if (source.getSchedules().empty() || source.getLabSections().empty() || source.getRooms().empty()) {
+                cout << "[ERROR] No dataset found. Run 'generate' first or omit --no-generate.\n";
+                return;
+            }
+            copy = make_shared<MemoryEngine>();
+            source.copyFilesTo(*copy);
+        }
+        DataManager dm(copy);
+        HoDReportGenerator reporter(dm);
+        const auto& schedules = dm.getSchedules();
+        const auto& sections = dm.getLabSections();
+        const auto& rooms = dm.getRooms();
+        int personCount = (int)dm.persons.size();
+        int firstPerson = dm.persons.front().personId;
+        int firstSection = sections.front().sectionId;
+        int firstRoom = rooms.front().roomId;
+        int firstBuilding = dm.getBuildings().front().buildingId;
+
+        long long sink = 0;
+        measure("isRoomAvailable", lookups, [&](long long) {
+            const ScheduleEntry& se = schedules[rng() % schedules.size()];
+            sink += dm.isRoomAvailable(rooms[rng() % rooms.size()].roomId, se.scheduledDate, se.expectedStart, se.expectedEnd);
+        });
+
+        // free-room search for a random session slot: per-room scan vs. one bitmap sweep
+        long long searches = 2000LL * scale;
+        measure("freeRooms via isRoomAvailable", searches, [&](long long) {
+            const ScheduleEntry& se = schedules[rng() % schedules.size()];
+            for (const auto& room : rooms) sink += dm.isRoomAvailable(room.roomId, se.scheduledDate, se.expectedStart, se.expectedEnd);
+        });
+        measure("freeRooms via findFreeRooms", searches, [&](long long) {
+            const ScheduleEntry& se = schedules[rng() % schedules.size()];
+            sink += dm.findFreeRooms(se.scheduledDate, se.expectedStart, se.expectedEnd).size();
+        });
+        measure("getPersonById", lookups, [&](long long) { sink += dm.getPersonById(firstPerson + (int)(rng() % personCount)) != nullptr; });
+        measure("getLabSectionById", lookups, [&](long long) { sink += dm.getLabSectionById(firstSection + (int)(rng() % sections.size())) != nullptr; });
+        measure("getRoomById", lookups, [&](long long) { sink += dm.getRoomById(firstRoom + (int)(rng() % rooms.size())) != nullptr; });
+        measure("getBuildingById", lookups, [&](long long) { sink += dm.getBuildingById(firstBuilding + (int)(rng() % dm.getBuildings().size())) != nullptr; });
+
+        // one section's sessions, the way the schedule views used to find them vs. through the planner
+        measure("section sessions via scan", searches, [&](long long) {
+            int secId = sections[rng() % sections.size()].sectionId;
+            for (size_t i = 0; i < schedules.size(); ++i) sink += schedules.sectionId(i) == secId;
+        });
+        measure("section sessions via select", searches, [&](long long) {
+            for (size_t pos : dm.select(ScheduleQuery().forSection(sections[rng() % sections.size()].sectionId))) sink += pos;
+        });
+        measure("select instructor week", searches, [&](long long) {
+            const ScheduleEntry& se = schedules[rng() % schedules.size()];
+            const LabSection* ls = dm.getLabSectionById(se.sectionId);
+            ScheduleQuery q;
+            q.between(se.scheduledDate, se.scheduledDate.addDays(6)).forInstructor(ls ? ls->instructorId : 0);
+            for (size_t pos : dm.select(q)) sink += pos;
+        });
+
+        // name search over people, courses, rooms and buildings
+        measure("search 3 letters", searches, [&](long long) {
+            string name = dm.persons[rng() % personCount].name;
+            sink += dm.search(name.substr(0, 3)).size();
+        });
+        measure("search full name", searches, [&](long long) {
+            sink += dm.search(dm.persons[rng() % personCount].name).size();
+        });
+
+        // appending mutators
+        Date probeDate = DatasetGenerator::semesterStart().addDays(-7);
+        int attendantId = 0;
+        vector<int> taIds;
+        for (const auto& p : dm.persons) {
+            if (p.role == Role::Attendant && !attendantId) attendantId = p.personId;
+            if (p.role == Role::TA) taIds.push_back(p.personId);
+        }
+        measure("addPerson", 1000, [&](long long i) { dm.addPerson("Bench Person " + to_string(i), Role::TA, "pass"); });
+        measure("addBuilding", 100, [&](long long i) { dm.addBuilding("Bench Block " + to_string(i), "Bench Road", attendantId); });
+        measure("addRoom", 1000, [&](long long i) { dm.addRoom("Bench-" + to_string(i), firstBuilding); });
+        measure("addCourse", 1000, [&](long long i) { dm.addCourse("BN" + to_string(i), "Bench Lab"); });
+        int benchCourse = dm.getCourses().back().courseId;
+        measure("addLabSection", 1000, [&](long long i) { dm.addLabSection(benchCourse, "B" + to_string(i)); });
+        measure("addScheduleEntry", 1000, [&](long long i) {
+            dm.addScheduleEntry(firstSection, firstRoom, probeDate.addDays((int)i), Time(8, 0), Time(11, 0));
+        });
+        measure("addMakeupRequest", 1000, [&](long long i) {
+            dm.addMakeupRequest(firstSection, 0, probeDate.addDays((int)i), Time(8, 0), Time(11, 0), "bench");
+        });
+
+        // mutators that rewrite a whole file; each assignTA adds a real TA to a section with room for one
+        vector<pair<int, int>> taAssignments; // (section, TA)
+        for (size_t s = 0; s < sections.size() && !taIds.empty() && (long long)taAssignments.size() < rewrites; ++s) {
+            const LabSection& ls = sections[s];
+            int taId = taIds[s % taIds.size()];
+            if (!ls.taIds.full() && find(ls.taIds.begin(), ls.taIds.end(), taId) == ls.taIds.end()) taAssignments.push_back({ ls.sectionId, taId });
+        }
+        measure("assignInstructor", rewrites, [&](long long) { dm.assignInstructor(firstSection, sections.front().instructorId); });
+        measure("assignTA", (long long)taAssignments.size(), [&](long long i) { dm.assignTA(taAssignments[i].first, taAssignments[i].second); });
+        measure("updateScheduleActualTime", rewrites, [&](long long) {
+            dm.updateScheduleActualTime(schedules[rng() % schedules.size()].scheduleId, Time(8, 0), Time(11, 0));
+        });
+        measure("updateMakeupRequestStatus", rewrites, [&](long long) {
+            if (!dm.getRequests().empty()) dm.updateMakeupRequestStatus(dm.getRequests()[rng() % dm.getRequests().size()].requestId, 2);
+        });
+        measure("cancelSchedules(1 day)", rewrites, [&](long long i) { dm.cancelSchedules(probeDate.addDays((int)i), probeDate.addDays((int)i)); });
+
+        // reports, console output discarded
+        NullBuffer nullBuffer;
+        streambuf* saved = cout.rdbuf(&nullBuffer);
+        // each cold run starts with an empty report cache
+        measure("generateLabScheduleReport", 3, [&](long long) { reporter.clearCache(); reporter.generateLabScheduleReport(); });
+        measure("generateTimeSheetReport", 3, [&](long long) { reporter.clearCache(); reporter.generateTimeSheetReport("Bench"); });
+        Date semester = DatasetGenerator::semesterStart();
+        measure("generateRoomUtilizationReport", 3, [&](long long) { reporter.clearCache(); reporter.generateRoomUtilizationReport(semester, semester.addDays(364)); });
+        measure("generateWorkloadReport", 3, [&](long long) { reporter.clearCache(); reporter.generateWorkloadReport(semester, semester.addDays(364)); });
+        measure("generateLabSummaryReport", 20, [&](long long i) { reporter.clearCache(); reporter.generateLabSummaryReport(sections[i % sections.size()].sectionId); });
+        // warm runs: nothing changed, then one timesheet filled between runs (batched, so the
+        // schedules.dat rewrite is not part of the timing)
+        reporter.generateLabScheduleReport();
+        measure("labScheduleReport cached", 20, [&](long long) { reporter.generateLabScheduleReport(); });
+        dm.beginBatch();
+        measure("labScheduleReport 1 change", 20, [&](long long) {
+            dm.updateScheduleActualTime(schedules[rng() % schedules.size()].scheduleId, Time(8, 0), Time(11, 0));
+            reporter.generateLabScheduleReport();
+        });
+        dm.commitBatch();
+        cout.rdbuf(saved);
+
+        volatile long long keep = sink; // keeps the lookups from being optimized away
+        (void)keep;
+    }
 
-                report << std::left << std::setw(15) << se.scheduledDate.toString()
-                    << std::setw(15) << se.expectedStart.toString()
-                    << std::setw(15) << se.expectedEnd.toString()
-                    << std::setw(15) << actStart
-                    << std::setw(15) << actEnd
-                    << std::setw(15) << durationStr
-                    << std::setw(15) << statusStr << std::endl;
-            }
+    // Loads, appends and rewrites against each storage engine. Both start from a copy of the data
+    // files, the file engine's in a scratch directory that is removed afterwards, so the gap between
+    // the two rows is what the disk costs.
+    void runStorage() {
+        DataManager source;
+        if (source.getSchedules().empty() || source.getLabSections().empty() || source.getRooms().empty()) return;
+        error_code ec;
+        filesystem::path scratch = filesystem::temp_directory_path(ec) / ("lms-bench-" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+        if (ec || !filesystem::create_directories(scratch, ec)) {
+            cout << "[ERROR] Could not create a scratch directory for the storage benchmark.\n";
+            return;
+        }
+        shared_ptr<StorageEngine> disk = make_shared<FileEngine>(scratch.string());
+        shared_ptr<StorageEngine> memory = make_shared<MemoryEngine>();
+        source.copyFilesTo(*disk);
+        source.copyFilesTo(*memory);
+        for (const auto& engine : { disk, memory }) {
+            string label = engine->describe() + ": ";
+            measure(label + "load", 3, [&](long long) { DataManager fresh(engine); });
+            DataManager dm(engine);
+            int section = dm.getLabSections().front().sectionId, room = dm.getRooms().front().roomId;
+            Date probeDate = DatasetGenerator::semesterStart().addDays(-7);
+            measure(label + "append schedule", 1000, [&](long long i) {
+                dm.addScheduleEntry(section, room, probeDate.addDays((int)i), Time(14, 0), Time(17, 0));
+            });
+            const auto& schedules = dm.getSchedules();
+            measure(label + "rewrite schedules", 10, [&](long long i) {
+                dm.updateScheduleActualTime(schedules.scheduleId((size_t)i * 7919 % schedules.size()), Time(8, 0), Time(11, 0));
+            });
         }
+        filesystem::remove_all(scratch, ec);
+    }
 
-        report << "\n\n--- SUMMARY ---\n";
-        report << "Total Contact Hours Logged: " << std::fixed << std::setprecision(2) << totalContactHours << " hours\n";
-        report << "Total Canceled/Leaves: " << leavesOrCancellations << " sessions\n";
+    void print(ostream& os) const {
+        os << left << setw(30) << "Operation" << right << setw(12) << "Iterations" << setw(14) << "Total (ms)"
+            << setw(16) << "ns/op" << setw(16) << "ops/s" << endl;
+        os << string(88, '-') << endl;
+        for (const auto& r : results) {
+            double nsPerOp = r.seconds * 1e9 / r.iterations;
+            os << left << setw(30) << r.name << right << setw(12) << r.iterations
+                << setw(14) << fixed << setprecision(2) << r.seconds * 1000.0
+                << setw(16) << setprecision(0) << nsPerOp
+                << setw(16) << (r.seconds > 0 ? r.iterations / r.seconds : 0.0) << endl;
+        }
+        os << "Peak RSS: " << peakRssKb() << " KB\n";
+    }
 
-        writeReportFile("LabSummaryReport_" + ls->getFullSectionCode(), report.str());
+    // machine-readable results, one "operation,iterations,ns_per_op,ops_per_s" line each
+    void writeCsv(const string& path) const {
+        ofstream ofs(path);
+        ofs << "operation,iterations,ns_per_op,ops_per_s\n";
+        for (const auto& r : results) {
+            ofs << r.name << "," << r.iterations << "," << fixed << setprecision(1) << r.seconds * 1e9 / r.iterations
+                << "," << (r.seconds > 0 ? r.iterations / r.seconds : 0.0) << "\n";
+        }
+        ofs << "peak_rss_kb," << peakRssKb() << ",,\n";
     }
 };
 
+// Hook around each menu action, e.g. for timing replayed sessions.
+class OperationObserver {
+public:
+    virtual void operationStarted(const char* name) = 0;
+    virtual void operationFinished(const char* name) = 0;
+    virtual ~OperationObserver() {}
+};
+
 // main
 
 class LabManagementSystem {
 private:
-    DataManager dm;
+    DataManager& dm;
     Authentication auth;
     HoDReportGenerator reporter;
-    const Person* loggedInUser = nullptr;
+    istream& in;
+    ostream& out;
+    OperationObserver* observer;
+    const Person* loggedInUser = nullptr; // persons live in a SlabStore, so this stays valid while others are added
+    const string STATS_FILE = "system_stats.json";
+    long long inputWaitNs = 0; // time spent blocked on prompts, left out of operation latency
+
+    // adds the lifetime of a prompt to inputWaitNs
+    class InputWait {
+    private:
+        long long& total;
+        chrono::steady_clock::time_point begin;
+    public:
+        InputWait(long long& t) : total(t), begin(chrono::steady_clock::now()) {}
+        ~InputWait() { total += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count(); }
+    };
+
+    // every menu action runs through here so observers see where it starts and ends,
+    // and its processing time (without prompt waits) lands in SystemStats
+    template <typename Fn>
+    void runOperation(const char* name, Fn action) {
+        if (observer) observer->operationStarted(name);
+        TraceSpan span("menu", name);
+        long long waitedBefore = inputWaitNs;
+        auto begin = chrono::steady_clock::now();
+        action();
+        long long elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+        SystemStats::instance().operation(string("menu.") + name).record((unsigned long long)max(0LL, elapsed - (inputWaitNs - waitedBefore)));
+        span.end();
+        if (observer) observer->operationFinished(name);
+    }
 
 
     long long getLongInput(const string& prompt) {
+        InputWait wait(inputWaitNs);
         long long val;
-        cout << prompt;
-        while (!(cin >> val)) {
-            cout << "Invalid input. Please enter a number: ";
-            cin.clear();
-            cin.ignore(10000, '\n');
+        out << prompt;
+        while (!(in >> val)) {
+            if (in.eof()) return 0; // end of input acts as "0 / back"
+            out << "Invalid input. Please enter a number: ";
+            in.clear();
+            in.ignore(10000, '\n');
         }
-        cin.ignore(10000, '\n');
+        in.ignore(10000, '\n');
         return val;
     }
 
     string getStringInput(const string& prompt) {
+        InputWait wait(inputWaitNs);
         string val;
-        cout << prompt;
-        getline(std::cin, val);
+        out << prompt;
+        getline(in, val);
         return val;
     }
 
     int getIntInput(const string& prompt) {
+        InputWait wait(inputWaitNs);
         int val;
-        cout << prompt;
-        while (!(std::cin >> val)) {
-            cout << "Invalid input. Please enter an integer: ";
-            cin.clear();
-            cin.ignore(10000, '\n');
+        out << prompt;
+        while (!(in >> val)) {
+            if (in.eof()) return 0; // end of input acts as "0 / back"
+            out << "Invalid input. Please enter an integer: ";
+            in.clear();
+            in.ignore(10000, '\n');
         }
-        cin.ignore(10000, '\n');
+        in.ignore(10000, '\n');
         return val;
     }
 
     Time getTimeInput(const string& prompt) {
+        InputWait wait(inputWaitNs);
         int h, m;
-        cout << prompt << " (HH:MM format, e.g., 14 30): ";
-        while (!(cin >> h >> m) || h < 0 || h > 23 || m < 0 || m > 59) {
-            cout << "Invalid time. Please use HH MM format (00-23 00-59): ";
-            cin.clear();
-            cin.ignore(10000, '\n');
+        out << prompt << " (HH:MM format, e.g., 14 30): ";
+        while (!(in >> h >> m) || h < 0 || h > 23 || m < 0 || m > 59) {
+            if (in.eof()) return Time();
+            out << "Invalid time. Please use HH MM format (00-23 00-59): ";
+            in.clear();
+            in.ignore(10000, '\n');
         }
-        cin.ignore(10000, '\n');
+        in.ignore(10000, '\n');
         return Time(h, m);
     }
 
     Date getDateInput(const string& prompt) {
+        InputWait wait(inputWaitNs);
         int d, m, y, w;
-        cout << prompt << " (DD MM YYYY Weekday(1-7, 1=Mon)): ";
-        while (!(cin >> d >> m >> y >> w) || d < 1 || d > 31 || m < 1 || m > 12 || y < 2024 || w < 1 || w > 7) {
-            cout << "Invalid date. Please use DD MM YYYY W format: ";
-            cin.clear();
-            cin.ignore(10000, '\n');
+        out << prompt << " (DD MM YYYY Weekday(1-7, 1=Mon)): ";
+        while (!(in >> d >> m >> y >> w) || d < 1 || d > 31 || m < 1 || m > 12 || y < 2024 || w < 1 || w > 7) {
+            if (in.eof()) return Date();
+            out << "Invalid date. Please use DD MM YYYY W format: ";
+            in.clear();
+            in.ignore(10000, '\n');
         }
-        cin.ignore(10000, '\n');
+        in.ignore(10000, '\n');
         return Date(d, m, y, (w == 7) ? 0 : w); 
     }
 
     // Academic Officer Functions 
     void aoMenu() {
         while (true) {
-            cout << "\n--- Academic Officer Menu ---\n";
-            cout << "1. Add Person (TA, Ins, HoD, Attendant)\n";
-            cout << "2. Add Lab Section\n"; 
-            cout << "3. Add Building\n";
-            cout << "4. Add Room to Building\n";
-            cout << "5. Assign TA to Lab Section\n";
-            cout << "6. Assign Instructor to Lab Section\n";
-            cout << "7. Schedule a Lab Session\n";
-            cout << "8. View All Scheduled Labs\n";
-            cout << "9. View Section Assignments\n";
-            cout << "10. View/Approve Makeup Lab Requests\n";
-            cout << "0. Logout\n";
+            out << "\n--- Academic Officer Menu ---\n";
+            out << "1. Add Person (TA, Ins, HoD, Attendant)\n";
+            out << "2. Add Lab Section\n"; 
+            out << "3. Add Building\n";
+            out << "4. Add Room to Building\n";
+            out << "5. Assign TA to Lab Section\n";
+            out << "6. Assign Instructor to Lab Section\n";
+            out << "7. Schedule a Lab Session\n";
+            out << "8. View All Scheduled Labs\n";
+            out << "9. View Section Assignments\n";
+            out << "10. View/Approve Makeup Lab Requests\n";
+            out << "11. Declare Holiday / Leave (cancels affected sessions)\n";
+            out << "12. View Holiday Calendar\n";
+            out << "13. Bulk Cancel Sessions\n";
+            out << "14. System Statistics\n";
+            out << "15. Archive Closed Semesters\n";
+            out << "16. Search People, Courses and Rooms\n";
+            out << "0. Logout\n";
             int choice = getIntInput("Enter choice: ");
 
             if (choice == 0) return;
             switch (choice) {
-            case 1: ao_addPerson(); break;
-            case 2: ao_addLabSection(); break; 
-            case 3: ao_addBuilding(); break;
-            case 4: ao_addRoomToBuilding(); break;
-            case 5: ao_assignTA(); break;
-            case 6: ao_assignInstructor(); break;
-            case 7: ao_scheduleLab(); break;
-            case 8: ao_viewScheduledLabs(); break;
-            case 9: ao_viewSectionAssignments(); break;
-            case 10: ao_handleMakeupRequests(); break;
-            default: cout << "Invalid choice.\n";
+            case 1: runOperation("ao.addPerson", [&] { ao_addPerson(); }); break;
+            case 2: runOperation("ao.addLabSection", [&] { ao_addLabSection(); }); break; 
+            case 3: runOperation("ao.addBuilding", [&] { ao_addBuilding(); }); break;
+            case 4: runOperation("ao.addRoomToBuilding", [&] { ao_addRoomToBuilding(); }); break;
+            case 5: runOperation("ao.assignTA", [&] { ao_assignTA(); }); break;
+            case 6: runOperation("ao.assignInstructor", [&] { ao_assignInstructor(); }); break;
+            case 7: runOperation("ao.scheduleLab", [&] { ao_scheduleLab(); }); break;
+            case 8: runOperation("ao.viewScheduledLabs", [&] { ao_viewScheduledLabs(); }); break;
+            case 9: runOperation("ao.viewSectionAssignments", [&] { ao_viewSectionAssignments(); }); break;
+            case 10: runOperation("ao.handleMakeupRequests", [&] { ao_handleMakeupRequests(); }); break;
+            case 11: runOperation("ao.declareHoliday", [&] { ao_declareHoliday(); }); break;
+            case 12: runOperation("ao.viewHolidays", [&] { ao_viewHolidays(); }); break;
+            case 13: runOperation("ao.bulkCancel", [&] { ao_bulkCancel(); }); break;
+            case 14: runOperation("ao.systemStats", [&] { showSystemStats(); }); break;
+            case 15: runOperation("ao.archiveSemesters", [&] { ao_archiveSemesters(); }); break;
+            case 16: runOperation("ao.search", [&] { ao_search(); }); break;
+            default: out << "Invalid choice.\n";
             }
         }
     }
 
     void ao_addPerson() {
         std::string name = getStringInput("Enter person's name: ");
-        std::string role = getStringInput("Enter role (Instructor, TA, HoD, Attendant): ");
+        Role role = parseRole(getStringInput("Enter role (Instructor, TA, HoD, Attendant): "));
         std::string pass = getStringInput("Enter initial password: ");
-        if (role == "Instructor" || role == "TA" || role == "HoD" || role == "Attendant" || role == "AcademicOfficer") {
+        if (role != Role::None) {
             long long newId = dm.addPerson(name, role, pass);
-            cout << "Added " << role << ". ID: " << newId << ", Password: " << pass << endl;
+            out << "Added " << role << ". ID: " << newId << ", Password: " << pass << endl;
         }
         else {
-            cout << "Invalid role specified.\n";
+            out << "Invalid role specified.\n";
         }
     }
 
@@ -991,34 +5869,29 @@ private:
         string courseName;
         int courseId = 0;
 
-        // Check if Course already exists by courseCode (by checking existing sections)
-        for (const auto& ls : dm.getLabSections()) {
-            if (ls.courseCode == courseCode) {
-                courseId = ls.courseId;
-                courseName = ls.courseName;
-                cout << "Course '" << courseName << "' already exists (ID: " << courseId << "). Adding section to it.\n";
-                break;
+        const Course* course = dm.getCourseByCode(courseCode);
+        if (course) {
+            courseId = course->courseId;
+            courseName = course->courseName;
+            out << "Course '" << courseName << "' already exists (ID: " << courseId << "). Adding section to it.\n";
+
+            // Check if this specific section already exists for this course
+            for (const auto& ls : dm.getLabSections()) {
+                if (ls.courseId == courseId && ls.sectionName == sectionName) {
+                    out << "Section " << sectionName << " for Course " << courseCode << " already exists (ID: " << ls.sectionId << ").\n";
+                    return;
+                }
             }
         }
-
-        // If Course doesn't exist, prompt for name and create synthetic ID
-        if (courseId == 0) {
-            cout << "Course code " << courseCode << " not found. Please provide details to create the Course.\n";
+        else {
+            out << "Course code " << courseCode << " not found. Please provide details to create the Course.\n";
             courseName = getStringInput("Enter full Course Name (e.g., Data Structures Lab): ");
-            courseId = dm.getNextId(dm.nextCourseId);
-        }
-
-        // Check if this specific section already exists for this course
-        for (const auto& ls : dm.getLabSections()) {
-            if (ls.courseCode == courseCode && ls.sectionName == sectionName) {
-                cout << "Section " << sectionName << " for Course " << courseCode << " already exists (ID: " << ls.sectionId << ").\n";
-                return;
-            }
+            courseId = dm.addCourse(courseCode, courseName);
         }
 
         // Add the Lab Section
-        int newId = dm.addLabSection(courseId, courseCode, courseName, sectionName);
-        cout << "Added Lab Section. Full Code: " << courseCode << "-" << sectionName << ", Course Name: " << courseName << ", Section ID: " << newId << endl;
+        int newId = dm.addLabSection(courseId, sectionName);
+        out << "Added Lab Section. Full Code: " << courseCode << "-" << sectionName << ", Course Name: " << courseName << ", Section ID: " << newId << endl;
     }
 
     void ao_addBuilding() {
@@ -1027,48 +5900,48 @@ private:
         int aId = getLongInput("Enter Attendant ID responsible for this building: ");
 
         const Person* attendant = dm.getPersonById(aId);
-        if (!attendant || attendant->getRole() != "Attendant") {
-            cout << "Attendant ID not found or is not an Attendant. Aborting building creation.\n";
+        if (!attendant || attendant->getRole() != Role::Attendant) {
+            out << "Attendant ID not found or is not an Attendant. Aborting building creation.\n";
             return;
         }
 
         int newId = dm.addBuilding(name, address, aId);
-        cout << "Added Building. ID: " << newId << ", Attendant ID: " << aId << endl;
+        out << "Added Building. ID: " << newId << ", Attendant ID: " << aId << endl;
     }
 
     void ao_addRoomToBuilding() {
-        cout << "\n--- Existing Buildings ---\n";
-        cout << left << setw(10) << "ID" << std::setw(20) << "Name" << setw(20) << "Attendant ID" << endl;
-        cout << string(50, '-') << endl;
+        out << "\n--- Existing Buildings ---\n";
+        out << left << setw(10) << "ID" << std::setw(20) << "Name" << setw(20) << "Attendant ID" << endl;
+        out << string(50, '-') << endl;
         for (const auto& b : dm.getBuildings()) {
-            cout << left << setw(10) << b.buildingId << setw(20) << b.name << std::setw(20) << b.attendantId << std::endl;
+            out << left << setw(10) << b.buildingId << setw(20) << b.name << std::setw(20) << b.attendantId << std::endl;
         }
 
         int bId = getLongInput("Enter Building ID to add room to: ");
         const Building* b = dm.getBuildingById(bId);
         if (!b) {
-            cout << "Invalid Building ID.\n";
+            out << "Invalid Building ID.\n";
             return;
         }
 
         string rName = getStringInput("Enter Room Name (e.g., G-101): ");
         int newId = dm.addRoom(rName, bId);
-        cout << "Added Room " << rName << " to Building " << b->getName() << ". Room ID: " << newId << endl;
+        out << "Added Room " << rName << " to Building " << b->getName() << ". Room ID: " << newId << endl;
     }
 
     void ao_assignTA() {
         int secId = getLongInput("Enter Lab Section ID to assign TA: ");
         int taId = getLongInput("Enter TA ID: ");
 
-        if (!dm.getLabSectionById(secId)) { cout << "[ERROR] Invalid Lab Section ID.\n"; return; }
+        if (!dm.getLabSectionById(secId)) { out << "[ERROR] Invalid Lab Section ID.\n"; return; }
         const Person* ta = dm.getPersonById(taId);
-        if (!ta || ta->role != "TA") { cout << "[ERROR] Invalid TA ID.\n"; return; }
+        if (!ta || ta->role != Role::TA) { out << "[ERROR] Invalid TA ID.\n"; return; }
 
         if (dm.assignTA(secId, taId)) {
-            cout << "TA ID " << taId << " assigned to Section ID " << secId << endl;
+            out << "TA ID " << taId << " assigned to Section ID " << secId << endl;
         }
         else {
-            cout << "Assignment failed (perhaps too many TAs already).\n";
+            out << "Assignment failed (TA already assigned, or the section already has " << LabSection::MAX_TAS << " TAs).\n";
         }
     }
 
@@ -1076,15 +5949,15 @@ private:
         int secId = getLongInput("Enter Lab Section ID to assign Instructor: ");
         int insId = getLongInput("Enter Instructor ID: ");
 
-        if (!dm.getLabSectionById(secId)) { cout << "[ERROR] Invalid Lab Section ID.\n"; return; }
+        if (!dm.getLabSectionById(secId)) { out << "[ERROR] Invalid Lab Section ID.\n"; return; }
         const Person* ins = dm.getPersonById(insId);
-        if (!ins || ins->role != "Instructor") { cout << "[ERROR] Invalid Instructor ID.\n"; return; }
+        if (!ins || ins->role != Role::Instructor) { out << "[ERROR] Invalid Instructor ID.\n"; return; }
 
         if (dm.assignInstructor(secId, insId)) {
-            cout << "Instructor ID " << insId << " assigned to Section ID " << secId << endl;
+            out << "Instructor ID " << insId << " assigned to Section ID " << secId << endl;
         }
         else {
-            cout << "Assignment failed.\n";
+            out << "Assignment failed.\n";
         }
     }
 
@@ -1094,27 +5967,30 @@ private:
         Time start = getTimeInput("Enter expected start time ");
         Time end = getTimeInput("Enter expected end time ");
 
-        if (!dm.getLabSectionById(secId)) { cout << "[ERROR] Invalid Lab Section ID.\n"; return; }
+        if (!dm.getLabSectionById(secId)) { out << "[ERROR] Invalid Lab Section ID.\n"; return; }
 
-        // Find available rooms
-        vector<const Room*> availableRooms;
-        for (const auto& room : dm.getRooms()) {
-            if (dm.isRoomAvailable(room.roomId, date, start, end)) {
-                availableRooms.push_back(&room);
-            }
+        const Holiday* holiday = dm.getHoliday(date, secId);
+        if (holiday) {
+            out << "[ERROR] " << date.toString() << " is a holiday (" << holiday->description << "). Lab not scheduled.\n";
+            return;
         }
 
+        // Find available rooms, leaving out buildings closed that day
+        vector<const Room*> availableRooms = dm.findFreeRooms(date, start, end);
+        availableRooms.erase(remove_if(availableRooms.begin(), availableRooms.end(),
+            [&](const Room* r) { return dm.getHoliday(date, secId, r->roomId) != nullptr; }), availableRooms.end());
+
         if (availableRooms.empty()) {
-            cout << "No rooms available for the specified time slot.\n";
+            out << "No rooms available for the specified time slot.\n";
             return;
         }
 
-        cout << "\n--- Available Rooms ---\n";
-        cout << left << setw(10) << "ID" << setw(15) << "Room Name" << setw(20) << "Building" << std::endl;
-        cout << string(45, '-') << std::endl;
+        out << "\n--- Available Rooms ---\n";
+        out << left << setw(10) << "ID" << setw(15) << "Room Name" << setw(20) << "Building" << std::endl;
+        out << string(45, '-') << std::endl;
         for (const auto* room : availableRooms) {
             const Building* b = dm.getBuildingById(room->buildingId);
-            cout << left << setw(10) << room->roomId << setw(15) << room->roomName << setw(20) << (b ? b->getName() : "N/A") << std::endl;
+            out << left << setw(10) << room->roomId << setw(15) << room->roomName << setw(20) << (b ? b->getName() : "N/A") << std::endl;
         }
 
         int rId = getLongInput("Enter the Room ID you wish to assign: ");
@@ -1128,76 +6004,216 @@ private:
 
         if (roomExists) {
             int newId = dm.addScheduleEntry(secId, rId, date, start, end);
-            cout << "Lab scheduled! Schedule ID: " << newId << endl;
+            out << "Lab scheduled! Schedule ID: " << newId << endl;
         }
         else {
-            cout << "Invalid or unavailable Room ID selected.\n";
+            out << "Invalid or unavailable Room ID selected.\n";
         }
     }
 
-    void ao_viewScheduledLabs() {
-        cout << "\n--- ALL SCHEDULED LAB SESSIONS ---\n";
-        const auto& schedules = dm.getSchedules();
-
-        cout << left << setw(12) << "ID" << setw(15) << "Section Code" << setw(15) << "Date"
-            << setw(10) << "Day" << setw(10) << "Start" << setw(10) << "End"
-            << setw(30) << "Venue" << setw(15) << "Status" << endl;
-        cout << string(107, '-') << endl;
+    // Paged listings: PAGE_ROWS rows at a time, each page formatted into one buffer and written
+    // with a single flush. After a page, pagerCommand reads what to do next; the cursors of the
+    // pages already seen are kept, so going back does not walk the data again.
+    static const size_t PAGE_ROWS = 20;
+
+    // reads a pager command into its letter and the rest of the line; "0", "q" or end of input go back
+    char pagerCommand(const string& extra, istringstream& args) {
+        string line = getStringInput("\n[n]ext  [p]revious  " + extra + "  [f]ilter key=value ... ([f] alone clears)  [0] back: ");
+        args.clear();
+        args.str(line);
+        string word;
+        if (!(args >> word) || word == "0" || word == "q") return '0';
+        return word.size() == 1 ? word[0] : '?';
+    }
 
-        for (const auto& se : schedules) {
-            const LabSection* ls = dm.getLabSectionById(se.sectionId);
-            string venueInfo = reporter.getRoomInfo(se.roomId);
-            string status = se.isMakeup ? "Makeup" : (se.isCanceled ? "Canceled" : (se.status == 1 ? "Filled" : "Scheduled"));
+    // key=value words of a filter command; false, with a message, if a key is not in keys
+    bool parseFilter(istringstream& args, const vector<string>& keys, map<string, string>& values) {
+        string word;
+        while (args >> word) {
+            size_t eq = word.find('=');
+            string key = word.substr(0, eq);
+            if (eq == string::npos || find(keys.begin(), keys.end(), key) == keys.end()) {
+                out << "Unknown filter '" << word << "'.\n";
+                return false;
+            }
+            values[key] = word.substr(eq + 1);
+        }
+        return true;
+    }
 
-            cout << left << std::setw(12) << se.scheduleId
-                << setw(15) << (ls ? ls->getFullSectionCode() : "N/A")
-                << setw(15) << se.scheduledDate.toString()
-                << setw(10) << se.scheduledDate.getWeekdayString().substr(0, 3)
-                << setw(10) << se.expectedStart.toString()
-                << setw(10) << se.expectedEnd.toString()
-                << setw(30) << venueInfo
-                << setw(15) << status << std::endl;
+    // sessions in date order through DataManager::scheduleDatePage
+    void ao_viewScheduledLabs() {
+        const auto& schedules = dm.getSchedules();
+        ScheduleQuery query;
+        ScheduleRange filter = dm.select(query);
+        ScheduleCursor cursor;
+        vector<ScheduleCursor> previous; // where each earlier page started
+        vector<size_t> page;
+        istringstream args;
+        while (true) {
+            ScheduleCursor next = cursor;
+            bool more = dm.scheduleDatePage(filter, next, PAGE_ROWS, page);
+
+            stringstream text;
+            text << "\n--- ALL SCHEDULED LAB SESSIONS (page " << previous.size() + 1 << ") ---\n";
+            text << left << setw(12) << "ID" << setw(15) << "Section Code" << setw(15) << "Date"
+                << setw(10) << "Day" << setw(10) << "Start" << setw(10) << "End"
+                << setw(30) << "Venue" << setw(15) << "Status" << "\n";
+            text << string(107, '-') << "\n";
+            for (size_t pos : page) {
+                ScheduleEntry se = schedules[pos];
+                const LabSection* ls = dm.getLabSectionById(se.sectionId);
+                string status = se.isMakeup ? "Makeup" : (se.isCanceled ? "Canceled" : (se.status == 1 ? "Filled" : "Scheduled"));
+                text << left << setw(12) << se.scheduleId
+                    << setw(15) << (ls ? dm.getFullSectionCode(*ls) : "N/A")
+                    << setw(15) << se.scheduledDate.toString()
+                    << setw(10) << se.scheduledDate.getWeekdayString().substr(0, 3)
+                    << setw(10) << se.expectedStart.toString()
+                    << setw(10) << se.expectedEnd.toString()
+                    << setw(30) << reporter.getRoomInfo(se.roomId)
+                    << setw(15) << status << "\n";
+            }
+            if (page.empty()) text << (previous.empty() ? "No sessions found.\n" : "No more sessions.\n");
+            else if (!more) text << "(end of list)\n";
+            out << text.str() << flush;
+
+            switch (pagerCommand("[d] DD/MM/YYYY go to date", args)) {
+            case '0': return;
+            case 'n':
+                if (page.empty()) break;
+                previous.push_back(cursor);
+                cursor = next;
+                break;
+            case 'p':
+                if (previous.empty()) break;
+                cursor = previous.back();
+                previous.pop_back();
+                break;
+            case 'd': {
+                string dateText;
+                Date date;
+                if (!(args >> dateText) || !Date::parse(dateText, date)) {
+                    out << "Invalid date. Please use DD/MM/YYYY.\n";
+                    break;
+                }
+                previous.clear();
+                cursor = ScheduleCursor();
+                cursor.dateKey = date.toKey();
+                break;
+            }
+            case 'f': {
+                map<string, string> values;
+                if (!parseFilter(args, { "section", "room", "building", "instructor", "ta", "status" }, values)) break;
+                query = ScheduleQuery();
+                query.forSection(atoi(values["section"].c_str())).inRoom(atoi(values["room"].c_str()))
+                    .inBuilding(atoi(values["building"].c_str())).forInstructor(atoi(values["instructor"].c_str()))
+                    .forTA(atoi(values["ta"].c_str()));
+                if (values.count("status")) query.withStatus(atoi(values["status"].c_str()));
+                filter = dm.select(query);
+                previous.clear();
+                cursor = ScheduleCursor();
+                break;
+            }
+            default: out << "Invalid choice.\n";
+            }
         }
     }
 
+    // sections in ID order; the cursor is a position in the section table
     void ao_viewSectionAssignments() {
-        cout << "\n--- LAB SECTION ASSIGNMENTS ---\n";
         const auto& labSections = dm.getLabSections();
-
-        cout << std::left << std::setw(10) << "ID" << std::setw(25) << "Section Code" << std::setw(25) << "Course Name" << std::setw(15) << "Instructor" << std::setw(50) << "TA(s)" << std::endl;
-        cout << std::string(125, '-') << std::endl;
-
-        for (const auto& ls : labSections) {
-            std::string insName = reporter.getPersonName(ls.instructorId);
-            std::stringstream taNames;
-            for (size_t i = 0; i < ls.taIds.size(); ++i) {
-                const Person* ta = dm.getPersonById(ls.taIds[i]);
-                taNames << (ta ? ta->getName() : "N/A") << (i < ls.taIds.size() - 1 ? ", " : "");
+        int instructorFilter = 0, taFilter = 0;
+        string courseFilter; // course code prefix
+        auto matches = [&](const LabSection& ls) {
+            if (instructorFilter != 0 && ls.instructorId != instructorFilter) return false;
+            if (taFilter != 0 && find(ls.taIds.begin(), ls.taIds.end(), taFilter) == ls.taIds.end()) return false;
+            return courseFilter.empty() || dm.getFullSectionCode(ls).compare(0, courseFilter.size(), courseFilter) == 0;
+        };
+        size_t cursor = 0;
+        vector<size_t> previous;
+        istringstream args;
+        while (true) {
+            size_t next = cursor;
+            stringstream text;
+            text << "\n--- LAB SECTION ASSIGNMENTS (page " << previous.size() + 1 << ") ---\n";
+            text << left << setw(10) << "ID" << setw(25) << "Section Code" << setw(25) << "Course Name" << setw(15) << "Instructor" << setw(50) << "TA(s)" << "\n";
+            text << string(125, '-') << "\n";
+            size_t rows = 0;
+            for (; next < labSections.size() && rows < PAGE_ROWS; ++next) {
+                const LabSection& ls = labSections[next];
+                if (!matches(ls)) continue;
+                rows++;
+                string taNames;
+                for (size_t i = 0; i < ls.taIds.size(); ++i) {
+                    const Person* ta = dm.getPersonById(ls.taIds[i]);
+                    taNames += (ta ? ta->getName() : string("N/A")) + (i < ls.taIds.size() - 1 ? ", " : "");
+                }
+                text << left << setw(10) << ls.sectionId
+                    << setw(25) << dm.getFullSectionCode(ls)
+                    << setw(25) << dm.getCourseName(ls)
+                    << setw(15) << reporter.getPersonName(ls.instructorId)
+                    << setw(50) << taNames << "\n";
+            }
+            if (rows == 0) text << (previous.empty() ? "No lab sections found.\n" : "No more lab sections.\n");
+            else if (next == labSections.size()) text << "(end of list)\n";
+            out << text.str() << flush;
+
+            switch (pagerCommand("[j] ID jump to section", args)) {
+            case '0': return;
+            case 'n':
+                if (rows == 0) break;
+                previous.push_back(cursor);
+                cursor = next;
+                break;
+            case 'p':
+                if (previous.empty()) break;
+                cursor = previous.back();
+                previous.pop_back();
+                break;
+            case 'j': {
+                int id = 0;
+                args >> id;
+                // section ids are handed out in ascending order, so the table is sorted by id
+                size_t lo = 0, hi = labSections.size();
+                while (lo < hi) {
+                    size_t mid = (lo + hi) / 2;
+                    if (labSections[mid].sectionId < id) lo = mid + 1;
+                    else hi = mid;
+                }
+                previous.clear();
+                cursor = lo;
+                break;
+            }
+            case 'f': {
+                map<string, string> values;
+                if (!parseFilter(args, { "instructor", "ta", "course" }, values)) break;
+                instructorFilter = atoi(values["instructor"].c_str());
+                taFilter = atoi(values["ta"].c_str());
+                courseFilter = values["course"];
+                previous.clear();
+                cursor = 0;
+                break;
+            }
+            default: out << "Invalid choice.\n";
             }
-
-            cout << std::left << std::setw(10) << ls.sectionId
-                << std::setw(25) << ls.getFullSectionCode()
-                << std::setw(25) << ls.getCourseName()
-                << std::setw(15) << insName
-                << std::setw(50) << taNames.str() << std::endl;
         }
     }
 
     void ao_handleMakeupRequests() {
-        cout << "\n--- PENDING MAKEUP REQUESTS ---\n";
+        out << "\n--- PENDING MAKEUP REQUESTS ---\n";
         const auto& requests = dm.getRequests();
         vector<const MakeupRequest*> pendingRequests;
 
-        cout << left << std::setw(10) << "Req ID" << std::setw(15) << "Section Code" << std::setw(15) << "Instructor"
+        out << left << std::setw(10) << "Req ID" << std::setw(15) << "Section Code" << std::setw(15) << "Instructor"
             << std::setw(15) << "Date" << setw(10) << "Start" << std::setw(10) << "End" << std::setw(30) << "Reason" << std::endl;
-        cout << std::string(105, '-') << endl;
+        out << std::string(105, '-') << endl;
 
         for (const auto& mr : requests) {
             if (mr.status == 0) {
                 pendingRequests.push_back(&mr);
                 const LabSection* ls = dm.getLabSectionById(mr.sectionId);
-                cout << std::left << std::setw(10) << mr.requestId
-                    << setw(15) << (ls ? ls->getFullSectionCode() : "N/A")
+                out << std::left << std::setw(10) << mr.requestId
+                    << setw(15) << (ls ? dm.getFullSectionCode(*ls) : "N/A")
                     << setw(15) << reporter.getPersonName(mr.instructorId)
                     << setw(15) << mr.requestedDate.toString()
                     << setw(10) << mr.requestedStart.toString()
@@ -1207,7 +6223,7 @@ private:
         }
 
         if (pendingRequests.empty()) {
-            cout << "No pending makeup requests.\n";
+            out << "No pending makeup requests.\n";
             return;
         }
 
@@ -1223,29 +6239,34 @@ private:
         }
 
         if (selectedReq) {
-            char action = getStringInput("Approve (A) or Disapprove (D)? ").at(0);
-            action = std::toupper(action);
+            string answer = getStringInput("Approve (A) or Disapprove (D)? ");
+            char action = answer.empty() ? ' ' : (char)std::toupper((unsigned char)answer[0]);
 
             if (action == 'A') {
-                std::vector<const Room*> availableRooms;
-                for (const auto& room : dm.getRooms()) {
-                    if (dm.isRoomAvailable(room.roomId, selectedReq->requestedDate, selectedReq->requestedStart, selectedReq->requestedEnd)) {
-                        availableRooms.push_back(&room);
-                    }
+                const Holiday* holiday = dm.getHoliday(selectedReq->requestedDate, selectedReq->sectionId);
+                if (holiday) {
+                    out << "[WARNING] Cannot approve: " << selectedReq->requestedDate.toString() << " is a holiday ("
+                        << holiday->description << "). Disapproving.\n";
+                    dm.updateMakeupRequestStatus(reqId, 2);
+                    return;
                 }
+                std::vector<const Room*> availableRooms = dm.findFreeRooms(selectedReq->requestedDate, selectedReq->requestedStart, selectedReq->requestedEnd);
+                availableRooms.erase(std::remove_if(availableRooms.begin(), availableRooms.end(), [&](const Room* r) {
+                    return dm.getHoliday(selectedReq->requestedDate, selectedReq->sectionId, r->roomId) != nullptr;
+                }), availableRooms.end());
 
                 if (availableRooms.empty()) {
-                    cout << "[WARNING] Cannot approve: No rooms available for the requested time. Disapproving.\n";
+                    out << "[WARNING] Cannot approve: No rooms available for the requested time. Disapproving.\n";
                     dm.updateMakeupRequestStatus(reqId, 2);
                     return;
                 }
 
-                cout << "\n--- Available Rooms for Makeup Session ---\n";
-                cout << std::left << std::setw(10) << "ID" << std::setw(15) << "Room Name" << std::setw(20) << "Building" << std::endl;
-                cout << std::string(45, '-') << std::endl;
+                out << "\n--- Available Rooms for Makeup Session ---\n";
+                out << std::left << std::setw(10) << "ID" << std::setw(15) << "Room Name" << std::setw(20) << "Building" << std::endl;
+                out << std::string(45, '-') << std::endl;
                 for (const auto* room : availableRooms) {
                     const Building* b = dm.getBuildingById(room->buildingId);
-                    cout << std::left << std::setw(10) << room->roomId << std::setw(15) << room->roomName << std::setw(20) << (b ? b->getName() : "N/A") << std::endl;
+                    out << std::left << std::setw(10) << room->roomId << std::setw(15) << room->roomName << std::setw(20) << (b ? b->getName() : "N/A") << std::endl;
                 }
 
                 long long rId = getLongInput("Enter the Room ID to assign for the makeup: ");
@@ -1260,96 +6281,204 @@ private:
                 if (roomExists) {
                     dm.updateMakeupRequestStatus(reqId, 1);
                     dm.addScheduleEntry(selectedReq->sectionId, rId, selectedReq->requestedDate, selectedReq->requestedStart, selectedReq->requestedEnd, true);
-                    cout << "Makeup Lab Approved and Scheduled in Room ID " << rId << std::endl;
+                    out << "Makeup Lab Approved and Scheduled in Room ID " << rId << std::endl;
                 }
                 else {
-                    cout << "Invalid Room ID selected. Request Disapproved.\n";
+                    out << "Invalid Room ID selected. Request Disapproved.\n";
                     dm.updateMakeupRequestStatus(reqId, 2);
                 }
 
             }
             else if (action == 'D') {
                 dm.updateMakeupRequestStatus(reqId, 2);
-                cout << "Makeup Lab Disapproved.\n";
+                out << "Makeup Lab Disapproved.\n";
             }
             else {
-                cout << "Invalid action. Request status unchanged.\n";
+                out << "Invalid action. Request status unchanged.\n";
             }
         }
         else {
-            cout << "Request ID not found in pending list.\n";
+            out << "Request ID not found in pending list.\n";
+        }
+    }
+
+    // reads the optional building/section/instructor filters shared by holidays and bulk cancel
+    bool getCancelScope(int& bId, int& secId, int& insId) {
+        bId = getLongInput("Building ID (0 for all buildings): ");
+        if (bId != 0 && !dm.getBuildingById(bId)) { out << "[ERROR] Invalid Building ID.\n"; return false; }
+        secId = getLongInput("Lab Section ID (0 for all sections): ");
+        if (secId != 0 && !dm.getLabSectionById(secId)) { out << "[ERROR] Invalid Lab Section ID.\n"; return false; }
+        insId = getLongInput("Instructor ID on leave (0 for all instructors): ");
+        if (insId != 0) {
+            const Person* ins = dm.getPersonById(insId);
+            if (!ins || ins->role != Role::Instructor) { out << "[ERROR] Invalid Instructor ID.\n"; return false; }
+        }
+        return true;
+    }
+
+    void ao_declareHoliday() {
+        Date from = getDateInput("Enter first day of holiday/leave ");
+        Date to = getDateInput("Enter last day of holiday/leave ");
+        if (to < from) { out << "[ERROR] Last day is before first day.\n"; return; }
+        string desc = getStringInput("Enter description (e.g., Eid holidays, Dr. X on leave): ");
+        int bId, secId, insId;
+        if (!getCancelScope(bId, secId, insId)) return;
+
+        int newId = dm.addHoliday(from, to, desc, bId, secId, insId);
+        int canceled = dm.cancelSchedules(from, to, bId, secId, insId);
+        if (canceled < 0) {
+            out << "[ERROR] Holiday recorded (ID: " << newId << ") but canceled sessions could not be saved.\n";
+            return;
+        }
+        out << "Holiday recorded. ID: " << newId << ". Sessions canceled: " << canceled << endl;
+    }
+
+    void ao_viewHolidays() {
+        out << "\n--- HOLIDAY / LEAVE CALENDAR ---\n";
+        out << left << setw(8) << "ID" << setw(13) << "From" << setw(13) << "To" << setw(30) << "Description"
+            << setw(25) << "Scope" << endl;
+        out << string(89, '-') << endl;
+
+        for (const auto& h : dm.getHolidays()) {
+            string scope = "Campus-wide";
+            if (!h.isCampusWide()) {
+                scope.clear();
+                if (h.buildingId != 0) scope += "Bldg " + to_string(h.buildingId) + " ";
+                if (h.sectionId != 0) scope += "Sec " + to_string(h.sectionId) + " ";
+                if (h.instructorId != 0) scope += "Leave: " + reporter.getPersonName(h.instructorId);
+            }
+            out << left << setw(8) << h.holidayId
+                << setw(13) << h.startDate.toString()
+                << setw(13) << h.endDate.toString()
+                << setw(30) << h.description
+                << setw(25) << scope << endl;
+        }
+    }
+
+    void ao_bulkCancel() {
+        Date from = getDateInput("Enter first day to cancel ");
+        Date to = getDateInput("Enter last day to cancel ");
+        if (to < from) { out << "[ERROR] Last day is before first day.\n"; return; }
+        int bId, secId, insId;
+        if (!getCancelScope(bId, secId, insId)) return;
+
+        int canceled = dm.cancelSchedules(from, to, bId, secId, insId);
+        if (canceled < 0) {
+            out << "[ERROR] Could not save canceled sessions.\n";
+            return;
+        }
+        out << "Sessions canceled: " << canceled << endl;
+    }
+
+    void ao_archiveSemesters() {
+        out << "\n--- ARCHIVED SEMESTERS ---\n";
+        out << left << setw(10) << "Semester" << setw(12) << "Sessions" << setw(12) << "Requests" << "Bytes" << endl;
+        out << string(44, '-') << endl;
+        for (const auto& a : dm.getArchivedSemesters()) {
+            out << left << setw(10) << ArchivedSemester::name(a.semester) << setw(12) << a.scheduleCount
+                << setw(12) << a.requestCount << a.fileBytes << endl;
+        }
+        Date cutoff = getDateInput("Enter a day of the first semester to keep active ");
+        int moved = dm.archiveSemestersBefore(cutoff);
+        if (moved < 0) {
+            out << "[ERROR] Could not write the archive.\n";
+            return;
+        }
+        out << "Sessions archived: " << moved << endl;
+    }
+
+    // type-ahead lookup, so IDs can be found without listing whole tables
+    void ao_search() {
+        while (true) {
+            string query = getStringInput("\nSearch names, codes and rooms (blank to go back): ");
+            if (query.empty()) return;
+            auto begin = chrono::steady_clock::now();
+            vector<SearchIndex::Hit> hits = dm.search(query, 10);
+            double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count();
+            stringstream text;
+            text << printSearchHits(dm, hits) << hits.size() << " match(es) in " << fixed << setprecision(1) << micros << " us\n";
+            out << text.str();
         }
     }
 
     
     void instructorMenu(int insId) {
         while (true) {
-            cout << "\n--- Instructor Menu (" << loggedInUser->name << ") ---\n";
-            cout << "1. View My Schedule\n";
-            cout << "2. Request a Makeup Lab\n";
-            cout << "0. Logout\n";
+            out << "\n--- Instructor Menu (" << loggedInUser->name << ") ---\n";
+            out << "1. View My Schedule\n";
+            out << "2. Request a Makeup Lab\n";
+            out << "0. Logout\n";
             int choice = getIntInput("Enter choice: ");
 
             if (choice == 0) return;
             switch (choice) {
-            case 1: instructor_viewSchedule(insId); break;
-            case 2: instructor_requestMakeupLab(insId); break;
-            default: cout << "Invalid choice.\n";
+            case 1: runOperation("instructor.viewSchedule", [&] { instructor_viewSchedule(insId); }); break;
+            case 2: runOperation("instructor.requestMakeupLab", [&] { instructor_requestMakeupLab(insId); }); break;
+            default: out << "Invalid choice.\n";
             }
         }
     }
 
     void instructor_viewSchedule(int insId) {
-        cout << "\n--- MY LAB SCHEDULE ---\n";
+        out << "\n--- MY LAB SCHEDULE ---\n";
+        printSchedule(ScheduleQuery().forInstructor(insId));
+    }
+
+    // one planner query, printed section by section in labs.dat order
+    void printSchedule(const ScheduleQuery& q) {
         const auto& sections = dm.getLabSections();
         const auto& schedules = dm.getSchedules();
 
-        cout << left << setw(15) << "Section Code" << setw(15) << "Date"
+        out << left << setw(15) << "Section Code" << setw(15) << "Date"
             << setw(10) << "Start" << setw(10) << "End" << setw(30) << "Venue" << endl;
-        cout << string(80, '-') << std::endl;
+        out << string(80, '-') << std::endl;
+
+        unordered_map<int, vector<size_t>> bySection;
+        for (size_t pos : dm.select(q)) bySection[schedules[pos].sectionId].push_back(pos);
 
         for (const auto& ls : sections) {
-            if (ls.getInstructorId() == insId) {
-                for (const auto& se : schedules) {
-                    if (se.sectionId == ls.sectionId) {
-                        string venueInfo = reporter.getRoomInfo(se.roomId);
-                        string status = se.isCanceled ? "Canceled" : (se.status == 1 ? "(Filled)" : "");
-
-                        cout << left
-                            << setw(15) << ls.getFullSectionCode()
-                            << setw(15) << se.scheduledDate.toString()
-                            << setw(10) << se.expectedStart.toString()
-                            << setw(10) << se.expectedEnd.toString()
-                            << setw(30) << venueInfo
-                            << status << endl;
-                    }
-                }
+            auto it = bySection.find(ls.sectionId);
+            if (it == bySection.end()) continue;
+            sort(it->second.begin(), it->second.end());
+            string sectionCode = dm.getFullSectionCode(ls);
+            for (size_t pos : it->second) {
+                const ScheduleEntry& se = schedules[pos];
+                string venueInfo = reporter.getRoomInfo(se.roomId);
+                string status = se.isCanceled ? "Canceled" : (se.status == 1 ? "(Filled)" : "");
+
+                out << left
+                    << setw(15) << sectionCode
+                    << setw(15) << se.scheduledDate.toString()
+                    << setw(10) << se.expectedStart.toString()
+                    << setw(10) << se.expectedEnd.toString()
+                    << setw(30) << venueInfo
+                    << status << endl;
             }
         }
     }
 
     void instructor_requestMakeupLab(int insId) {
-        cout << "\n--- Your Sections ---\n";
+        out << "\n--- Your Sections ---\n";
         const auto& sections = dm.getLabSections();
         vector<int> mySections;
-        cout << left << setw(10) << "ID" << setw(20) << "Section Code" << endl;
-        cout << string(30, '-') << endl;
+        out << left << setw(10) << "ID" << setw(20) << "Section Code" << endl;
+        out << string(30, '-') << endl;
         for (const auto& ls : sections) {
             if (ls.getInstructorId() == insId) {
                 
-                cout << left << setw(10) << ls.sectionId << setw(20) << ls.getFullSectionCode() << endl;
+                out << left << setw(10) << ls.sectionId << setw(20) << dm.getFullSectionCode(ls) << endl;
                 mySections.push_back(ls.sectionId);
             }
         }
 
         if (mySections.empty()) {
-            cout << "You are not assigned to any lab sections.\n";
+            out << "You are not assigned to any lab sections.\n";
             return;
         }
 
         int secId = getLongInput("Enter Section ID for makeup: ");
         if (find(mySections.begin(), mySections.end(), secId) == mySections.end()) {
-            cout << " Invalid Section ID or not assigned to you.\n";
+            out << " Invalid Section ID or not assigned to you.\n";
             return;
         }
 
@@ -1359,106 +6488,104 @@ private:
         string reason = getStringInput("Enter reason for makeup: ");
 
         int newId = dm.addMakeupRequest(secId, insId, date, start, end, reason);
-        cout << "Makeup Request submitted. Request ID: " << newId << ". Awaiting Academic Officer approval.\n";
+        out << "Makeup Request submitted. Request ID: " << newId << ". Awaiting Academic Officer approval.\n";
     }
 
     void taMenu(int taId) {
         while (true) {
-            cout << "\n--- TA Menu (" << loggedInUser->name << ") ---\n";
-            cout << "1. View My Schedule\n";
-            cout << "0. Logout\n";
+            out << "\n--- TA Menu (" << loggedInUser->name << ") ---\n";
+            out << "1. View My Schedule\n";
+            out << "0. Logout\n";
             int choice = getIntInput("Enter choice: ");
 
             if (choice == 0) return;
             switch (choice) {
-            case 1: ta_viewSchedule(taId); break;
-            default: cout << "Invalid choice.\n";
+            case 1: runOperation("ta.viewSchedule", [&] { ta_viewSchedule(taId); }); break;
+            default: out << "Invalid choice.\n";
             }
         }
     }
 
     void ta_viewSchedule(int taId) {
-        cout << "\n--- MY TA SCHEDULE ---\n";
-        const auto& sections = dm.getLabSections();
-        const auto& schedules = dm.getSchedules();
-
-        cout << left << setw(15) << "Section Code" << setw(15) << "Date"
-            << setw(10) << "Start" << setw(10) << "End" << setw(30) << "Venue" << endl;
-        cout << string(80, '-') << endl;
-
-        for (const auto& ls : sections) {
-            bool isMySection = false;
-            for (long long assignedTaId : ls.taIds) {
-                if (assignedTaId == taId) {
-                    isMySection = true;
-                    break;
-                }
-            }
-
-            if (isMySection) {
-                for (const auto& se : schedules) {
-                    if (se.sectionId == ls.sectionId) {
-                        string venueInfo = reporter.getRoomInfo(se.roomId);
-                        string status = se.isCanceled ? "Canceled" : (se.status == 1 ? "(Filled)" : "");
-
-                        cout << left
-
-                            << setw(15) << ls.getFullSectionCode()
-                            << setw(15) << se.scheduledDate.toString()
-                            << setw(10) << se.expectedStart.toString()
-                            << setw(10) << se.expectedEnd.toString()
-                            << setw(30) << venueInfo
-                            << status << endl;
-                    }
-                }
-            }
-        }
+        out << "\n--- MY TA SCHEDULE ---\n";
+        printSchedule(ScheduleQuery().forTA(taId));
     }
 
     void hodMenu() {
         while (true) {
-            cout << "\n--- Head of Department Menu (" << loggedInUser->name << ") ---\n";
-            cout << "1. Generate Complete Lab Schedule Report\n";
-            cout << "2. Generate Filled Time Sheet Report\n";
-            cout << "3. Generate Lab Summary Report (Contact Hours, Leaves)\n";
-            cout << "0. Logout\n";
+            out << "\n--- Head of Department Menu (" << loggedInUser->name << ") ---\n";
+            out << "1. Generate Complete Lab Schedule Report\n";
+            out << "2. Generate Filled Time Sheet Report\n";
+            out << "3. Generate Lab Summary Report (Contact Hours, Leaves)\n";
+            out << "4. System Statistics\n";
+            out << "5. Generate Room Utilization Heatmap Report\n";
+            out << "6. Generate Instructor/TA Workload Report\n";
+            out << "0. Logout\n";
             int choice = getIntInput("Enter choice: ");
 
             if (choice == 0) return;
             switch (choice) {
-            case 1: reporter.generateLabScheduleReport(); break;
-            case 2: {
-                string week = getStringInput("Enter Target Semester (e.g., Fall 2024): ");
-                reporter.generateTimeSheetReport(week);
-                break;
-            }
-            case 3: {
-                int secId = getLongInput("Enter Lab Section ID for Summary Report: ");
-                reporter.generateLabSummaryReport(secId);
-                break;
-            }
-            default: cout << "Invalid choice.\n";
+            case 1: runOperation("hod.labScheduleReport", [&] { reporter.generateLabScheduleReport(); }); break;
+            case 2: runOperation("hod.timeSheetReport", [&] { hod_timeSheetReport(); }); break;
+            case 3: runOperation("hod.labSummaryReport", [&] { hod_labSummaryReport(); }); break;
+            case 4: runOperation("hod.systemStats", [&] { showSystemStats(); }); break;
+            case 5: runOperation("hod.roomUtilizationReport", [&] { hod_roomUtilizationReport(); }); break;
+            case 6: runOperation("hod.workloadReport", [&] { hod_workloadReport(); }); break;
+            default: out << "Invalid choice.\n";
             }
         }
     }
 
+    // shared by the HoD and AO menus
+    void showSystemStats() {
+        out << "\n--- SYSTEM STATISTICS ---\n";
+        SystemStats::instance().print(out);
+        if (SystemStats::instance().dump(STATS_FILE)) {
+            out << "Machine-readable snapshot written to " << STATS_FILE << endl;
+        }
+    }
+
+    void hod_timeSheetReport() {
+        string week = getStringInput("Enter Target Semester (e.g., Fall 2024): ");
+        reporter.generateTimeSheetReport(week);
+    }
+
+    void hod_labSummaryReport() {
+        int secId = getLongInput("Enter Lab Section ID for Summary Report: ");
+        reporter.generateLabSummaryReport(secId);
+    }
+
+    void hod_roomUtilizationReport() {
+        Date from = getDateInput("Enter first day of period ");
+        Date to = getDateInput("Enter last day of period ");
+        if (to < from) { out << "[ERROR] Last day is before first day.\n"; return; }
+        reporter.generateRoomUtilizationReport(from, to);
+    }
+
+    void hod_workloadReport() {
+        Date from = getDateInput("Enter first day of period ");
+        Date to = getDateInput("Enter last day of period ");
+        if (to < from) { out << "[ERROR] Last day is before first day.\n"; return; }
+        reporter.generateWorkloadReport(from, to);
+    }
+
     void attendantMenu(int attId) {
         while (true) {
-            cout << "\n--- Attendant Menu (" << loggedInUser->name << ") ---\n";
-            cout << "1. Fill Time Sheet (Actual Lab Timings)\n";
-            cout << "0. Logout\n";
+            out << "\n--- Attendant Menu (" << loggedInUser->name << ") ---\n";
+            out << "1. Fill Time Sheet (Actual Lab Timings)\n";
+            out << "0. Logout\n";
             int choice = getIntInput("Enter choice: ");
 
             if (choice == 0) return;
             switch (choice) {
-            case 1: attendant_fillTimeSheet(attId); break;
-            default: cout << "Invalid choice.\n";
+            case 1: runOperation("attendant.fillTimeSheet", [&] { attendant_fillTimeSheet(attId); }); break;
+            default: out << "Invalid choice.\n";
             }
         }
     }
 
     void attendant_fillTimeSheet(int attId) {
-        cout << "\n--- FILL LAB TIME SHEET ---\n";
+        out << "\n--- FILL LAB TIME SHEET ---\n";
 
         vector<int> myRoomIds;
         for (const auto& building : dm.getBuildings()) {
@@ -1473,128 +6600,499 @@ private:
         }
 
         if (myRoomIds.empty()) {
-            cout << "You are not assigned to manage any buildings/rooms.\n";
+            out << "You are not assigned to manage any buildings/rooms.\n";
             return;
         }
 
         // Find sessions in those rooms that are scheduled but not yet filled
-        vector<const ScheduleEntry*> sessionsToFill;
-        cout << left << std::setw(10) << "Sch ID" << setw(15) << "Date" << setw(10) << "Exp. Start"
+        set<int> sessionsToFill; // schedule IDs
+        out << left << std::setw(10) << "Sch ID" << setw(15) << "Date" << setw(10) << "Exp. Start"
             << setw(10) << "Exp. End" << setw(30) << "Venue" << setw(15) << "Section" << endl;
-        cout << string(90, '-') << endl;
+        out << string(90, '-') << endl;
 
-        for (const auto& se : dm.getSchedules()) {
-            bool isMyRoom = false;
-            for (long long rId : myRoomIds) {
-                if (se.roomId == rId) {
-                    isMyRoom = true;
-                    break;
-                }
-            }
-
-            if (isMyRoom && se.status == 0) {
-                sessionsToFill.push_back(&se);
-                const LabSection* ls = dm.getLabSectionById(se.sectionId);
+        const ScheduleStore& schedules = dm.getSchedules();
+        for (size_t pos : dm.select(ScheduleQuery().forAttendant(attId).withStatus(0))) {
+            ScheduleEntry se = schedules[pos];
+            sessionsToFill.insert(se.scheduleId);
+            const LabSection* ls = dm.getLabSectionById(se.sectionId);
 
-                cout << left << setw(10) << se.scheduleId
-                    << setw(15) << se.scheduledDate.toString()
-                    << setw(10) << se.expectedStart.toString()
-                    << setw(10) << se.expectedEnd.toString()
-                    << setw(30) << reporter.getRoomInfo(se.roomId)
-                    << setw(15) << (ls ? ls->getFullSectionCode() : "N/A") << endl;
-            }
+            out << left << setw(10) << se.scheduleId
+                << setw(15) << se.scheduledDate.toString()
+                << setw(10) << se.expectedStart.toString()
+                << setw(10) << se.expectedEnd.toString()
+                << setw(30) << reporter.getRoomInfo(se.roomId)
+                << setw(15) << (ls ? dm.getFullSectionCode(*ls) : "N/A") << endl;
         }
 
         if (sessionsToFill.empty()) {
-            cout << "No scheduled sessions in your assigned rooms to fill timesheet for.\n";
+            out << "No scheduled sessions in your assigned rooms to fill timesheet for.\n";
             return;
         }
 
         long long schId = getLongInput("Enter Schedule ID to fill timesheet for (or 0 to exit): ");
         if (schId == 0) return;
 
-        const ScheduleEntry* selectedEntry = nullptr;
-        for (const auto* se : sessionsToFill) {
-            if (se->scheduleId == schId) {
-                selectedEntry = se;
-                break;
-            }
-        }
-
-        if (selectedEntry) {
-            cout << "\n--- Filling Timesheet for Schedule ID: " << schId << " ---\n";
+        if (sessionsToFill.count((int)schId)) {
+            out << "\n--- Filling Timesheet for Schedule ID: " << schId << " ---\n";
             Time actualStart = getTimeInput("Enter actual start time ");
             Time actualEnd = getTimeInput("Enter actual end time ");
 
             if (actualStart > actualEnd) {
-                cout << "Actual end time cannot be before actual start time. Timesheet not saved.\n";
+                out << "Actual end time cannot be before actual start time. Timesheet not saved.\n";
                 return;
             }
 
             if (dm.updateScheduleActualTime(schId, actualStart, actualEnd)) {
-                cout << "Timesheet filled successfully. Actual contact hours logged.\n";
+                out << "Timesheet filled successfully. Actual contact hours logged.\n";
             }
             else {
-                cout << "Failed to update schedule entry.\n";
+                out << "Failed to update schedule entry.\n";
             }
         }
         else {
-            cout << "Invalid Schedule ID or session is not assigned to your rooms.\n";
+            out << "Invalid Schedule ID or session is not assigned to your rooms.\n";
         }
     }
 
 public:
-    LabManagementSystem() : auth(dm), reporter(dm) {
+    // one line per hit: kind, id, name and what the record belongs to
+    static string printSearchHits(const DataManager& dm, const vector<SearchIndex::Hit>& hits) {
+        stringstream text;
+        text << left << setw(10) << "Kind" << setw(10) << "ID" << setw(35) << "Name" << "Details" << "\n";
+        text << string(80, '-') << "\n";
+        for (const auto& hit : hits) {
+            string details;
+            if (hit.table == ChangeTable::Person) {
+                const Person* p = dm.getPersonById(hit.id);
+                if (p) details = roleName(p->role);
+            }
+            else if (hit.table == ChangeTable::Room) {
+                const Room* r = dm.getRoomById(hit.id);
+                const Building* b = r ? dm.getBuildingById(r->buildingId) : nullptr;
+                if (b) details = "in " + b->getName();
+            }
+            else if (hit.table == ChangeTable::Building) {
+                const Building* b = dm.getBuildingById(hit.id);
+                if (b) details = b->address;
+            }
+            text << left << setw(10) << changeTableName(hit.table) << setw(10) << hit.id << setw(35) << hit.text << details << "\n";
+        }
+        return text.str();
+    }
+
+    LabManagementSystem(DataManager& dataManager, istream& input = cin, ostream& output = cout, OperationObserver* obs = nullptr)
+        : dm(dataManager), auth(dataManager), reporter(dataManager), in(input), out(output), observer(obs) {
         
         if (dm.persons.empty()) {
-            cout << "Creating default Academic Officer (ID 1001, Pass: 123).\n";
-            dm.addPerson("Default Academic Officer", "AcademicOfficer", "123");
+            out << "Creating default Academic Officer (ID 1001, Pass: 123).\n";
+            dm.addPerson("Default Academic Officer", Role::AcademicOfficer, "123");
         }
     }
 
     void run() {
-        cout << "--- Welcome to the Lab Management System ---\n";
+        out << "--- Welcome to the Lab Management System ---\n";
         while (true) {
             long long id = getLongInput("\nEnter your User ID (0 to exit): ");
             if (id == 0) break;
             string pass = getStringInput("Enter your Password: ");
 
-            loggedInUser = auth.authenticate(id, pass);
+            runOperation("login", [&] { loggedInUser = auth.authenticate(id, pass); });
 
             if (loggedInUser) {
-                cout << "\nWelcome, " << loggedInUser->name << " (" << loggedInUser->role << ").\n";
-                string role = loggedInUser->role;
-                if (role == "AcademicOfficer") {
-                    aoMenu();
+                int userId = loggedInUser->personId;
+                out << "\nWelcome, " << loggedInUser->name << " (" << loggedInUser->role << ").\n";
+                switch (loggedInUser->role) {
+                case Role::AcademicOfficer: aoMenu(); break;
+                case Role::Instructor: instructorMenu(userId); break;
+                case Role::TA: taMenu(userId); break;
+                case Role::HoD: hodMenu(); break;
+                case Role::Attendant: attendantMenu(userId); break;
+                default: break;
                 }
-                else if (role == "Instructor") {
-                    instructorMenu(loggedInUser->personId);
-                }
-                else if (role == "TA") {
-                    taMenu(loggedInUser->personId);
-                }
-                else if (role == "HoD") {
-                    hodMenu();
-                }
-                else if (role == "Attendant") {
-                    attendantMenu(loggedInUser->personId);
-                }
-          
+
                 loggedInUser = nullptr;
             }
             else {
-                cout << "Invalid User ID or Password. Please try again.\n";
+                out << "Invalid User ID or Password. Please try again.\n";
+            }
+        }
+        out << "\nExiting Lab Management System. Goodbye!\n";
+    }
+};
+
+
+// session record and replay
+
+// Copies every line the user types to a session file as "<ms since start>\t<line>".
+class InputRecorder : public streambuf {
+private:
+    istream& source;
+    ostream& log;
+    chrono::steady_clock::time_point start;
+    string current;
+
+protected:
+    int underflow() override {
+        if (!getline(source, current)) return traits_type::eof();
+        long long ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        log << ms << '\t' << current << '\n';
+        log.flush();
+        current += '\n';
+        setg(&current[0], &current[0], &current[0] + current.size());
+        return traits_type::to_int_type(current[0]);
+    }
+
+public:
+    InputRecorder(istream& src, ostream& sessionLog) : source(src), log(sessionLog), start(chrono::steady_clock::now()) {}
+};
+
+// Feeds recorded sessions through LabManagementSystem instances on one thread each, all sharing
+// one DataManager, with console output discarded. Menu actions are serialized by a single lock
+// (they are not safe to interleave) and timed from the moment they are requested, so the
+// percentiles include time spent queued behind other sessions.
+class ReplayDriver {
+private:
+    struct RecordedLine {
+        long long ms;
+        string text;
+    };
+
+    class Session : public streambuf, public OperationObserver {
+    private:
+        ReplayDriver& driver;
+        const vector<RecordedLine>& lines;
+        size_t next = 0;
+        string current;
+        bool inOperation = false;
+        chrono::steady_clock::time_point start, opBegin;
+
+    protected:
+        // think time between actions is honored when pacing; lines inside an action are immediate
+        int underflow() override {
+            if (next >= lines.size()) return traits_type::eof();
+            const RecordedLine& line = lines[next++];
+            if (driver.speed > 0 && !inOperation) {
+                this_thread::sleep_until(start + chrono::microseconds((long long)(line.ms * 1000.0 / driver.speed)));
+            }
+            current = line.text + '\n';
+            setg(&current[0], &current[0], &current[0] + current.size());
+            return traits_type::to_int_type(current[0]);
+        }
+
+    public:
+        Session(ReplayDriver& d, const vector<RecordedLine>& recorded) : driver(d), lines(recorded) {}
+
+        void begin() { start = chrono::steady_clock::now(); }
+
+        void operationStarted(const char*) override {
+            opBegin = chrono::steady_clock::now();
+            driver.operationLock.lock();
+            inOperation = true;
+        }
+
+        void operationFinished(const char* name) override {
+            inOperation = false;
+            auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - opBegin).count();
+            driver.latencies[name].record((unsigned long long)ns);
+            driver.operationLock.unlock();
+        }
+    };
+
+    DataManager& dm;
+    double speed;
+    mutex operationLock;
+    map<string, LatencyHistogram> latencies; // only touched while holding operationLock
+    vector<vector<RecordedLine>> recordings;
+
+public:
+    ReplayDriver(DataManager& dataManager, double pacing) : dm(dataManager), speed(pacing) {}
+
+    bool loadSession(const string& path) {
+        ifstream ifs(path);
+        if (!ifs) return false;
+        vector<RecordedLine> lines;
+        string line;
+        while (getline(ifs, line)) {
+            size_t tab = line.find('\t');
+            if (tab == string::npos) continue;
+            lines.push_back({ atoll(line.substr(0, tab).c_str()), line.substr(tab + 1) });
+        }
+        recordings.push_back(lines);
+        return true;
+    }
+
+    void run(int copies, ostream& report, const string& csvPath) {
+        NullBuffer nullBuffer;
+        ostream discard(&nullBuffer);
+        streambuf* savedCout = cout.rdbuf(&nullBuffer); // reports print to cout directly
+
+        // build every session up front; the constructor may touch dm
+        vector<unique_ptr<Session>> sessions;
+        vector<unique_ptr<istream>> inputs;
+        vector<unique_ptr<LabManagementSystem>> apps;
+        for (int c = 0; c < copies; ++c) {
+            for (const auto& rec : recordings) {
+                sessions.emplace_back(new Session(*this, rec));
+                inputs.emplace_back(new istream(sessions.back().get()));
+                apps.emplace_back(new LabManagementSystem(dm, *inputs.back(), discard, sessions.back().get()));
+            }
+        }
+
+        auto begin = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (size_t i = 0; i < apps.size(); ++i) {
+            sessions[i]->begin();
+            workers.emplace_back([&, i] { apps[i]->run(); });
+        }
+        for (auto& w : workers) w.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        cout.rdbuf(savedCout);
+
+        unsigned long long totalOps = 0;
+        report << left << setw(30) << "Operation" << right << setw(10) << "Count" << setw(12) << "p50 (ms)"
+            << setw(12) << "p90 (ms)" << setw(12) << "p99 (ms)" << setw(12) << "max (ms)" << endl;
+        report << string(88, '-') << endl;
+        for (const auto& entry : latencies) {
+            const LatencyHistogram& h = entry.second;
+            totalOps += h.count();
+            report << left << setw(30) << entry.first << right << setw(10) << h.count() << fixed << setprecision(3)
+                << setw(12) << h.percentile(0.50) / 1e6 << setw(12) << h.percentile(0.90) / 1e6
+                << setw(12) << h.percentile(0.99) / 1e6 << setw(12) << h.maxValue() / 1e6 << endl;
+        }
+        report << sessions.size() << " sessions, " << totalOps << " operations in " << setprecision(2) << seconds
+            << " s (" << setprecision(0) << (seconds > 0 ? totalOps / seconds : 0.0) << " ops/s)\n";
+
+        if (!csvPath.empty()) {
+            ofstream csv(csvPath);
+            csv << "operation,count,p50_ns,p90_ns,p99_ns,max_ns\n";
+            for (const auto& entry : latencies) {
+                const LatencyHistogram& h = entry.second;
+                csv << entry.first << "," << h.count() << "," << h.percentile(0.50) << "," << h.percentile(0.90)
+                    << "," << h.percentile(0.99) << "," << h.maxValue() << "\n";
             }
         }
-        cout << "\nExiting Lab Management System. Goodbye!\n";
     }
 };
 
 
-int main() {
+int main(int argc, char* argv[]) {
     
     DataManager::initializeStaticIds();
-    LabManagementSystem app;
+
+    // tracing: --trace <file> anywhere on the command line, or LMS_TRACE=<file>
+    // data files: --data-dir <dir>, or LMS_DATA_DIR=<dir>; the working directory by default
+    vector<char*> args;
+    const char* envTrace = getenv("LMS_TRACE");
+    const char* envDataDir = getenv("LMS_DATA_DIR");
+    string tracePath = envTrace ? envTrace : "";
+    string dataDir = envDataDir ? envDataDir : "";
+    for (int i = 0; i < argc; ++i) {
+        if (string(argv[i]) == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (string(argv[i]) == "--data-dir" && i + 1 < argc) dataDir = argv[++i];
+        else args.push_back(argv[i]);
+    }
+    argc = (int)args.size();
+    argv = args.data();
+    TraceSession traceSession(tracePath);
+    if (!dataDir.empty()) {
+        error_code ec;
+        filesystem::create_directories(dataDir, ec);
+        if (ec) {
+            cout << "[ERROR] Could not create data directory " << dataDir << ": " << ec.message() << endl;
+            return 1;
+        }
+        StorageEngine::standard() = make_shared<FileEngine>(dataDir);
+    }
+
+    string command = argc > 1 ? argv[1] : "";
+    if (command == "import") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " import <csv-directory>\n";
+            return 1;
+        }
+        DataManager dm;
+        CsvImporter importer(dm);
+        return importer.importDirectory(argv[2]) ? 0 : 1;
+    }
+    if (command == "run") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " run <script-file | ->\n";
+            return 1;
+        }
+        DataManager dm;
+        ScriptRunner runner(dm);
+        string path = argv[2];
+        if (path == "-") return runner.run(cin, "<stdin>") == 0 ? 0 : 1;
+        ifstream script(path);
+        if (!script) {
+            cout << "[ERROR] Could not open script " << path << endl;
+            return 1;
+        }
+        return runner.run(script, path) == 0 ? 0 : 1;
+    }
+    if (command == "generate" || command == "bench") {
+        // generating writes .dat files into the data directory, so refuse to touch existing data;
+        // bench --no-generate only reads them (the suite works on copies)
+        CommandOptions opt(argc, argv, 2);
+        bool reuse = command == "bench" && opt.has("no-generate");
+        StorageEngine& storage = *StorageEngine::standard();
+        if (!reuse && storage.size("persons.dat") >= 0 && !opt.has("force")) {
+            cout << "[ERROR] Data files already exist here. Run in an empty directory or pass --force.\n";
+            return 1;
+        }
+        if (!reuse) {
+            for (const char* f : { "persons.dat", "labs.dat", "courses.dat", "rooms.dat", "schedules.dat", "makeup_requests.dat", "buildings.dat", "holidays.dat", "archive.dat", "changes.log" }) {
+                storage.remove(f);
+            }
+            DatasetSpec spec = DatasetSpec::fromOptions(opt);
+            auto begin = chrono::steady_clock::now();
+            DataManager dm;
+            dm.setChangeCapture(false);
+            DatasetGenerator(dm, spec).generate();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            cout << "Generated " << dm.persons.size() << " persons, " << dm.getBuildings().size() << " buildings, "
+                << dm.getRooms().size() << " rooms, " << dm.getLabSections().size() << " sections, "
+                << dm.getSchedules().size() << " sessions, " << dm.getRequests().size() << " makeup requests in "
+                << fixed << setprecision(1) << seconds * 1000.0 << " ms\n";
+        }
+        if (command == "bench") {
+            BenchmarkSuite suite(opt.has("verbose"));
+            suite.run(max(1, opt.getInt("scale", 1)));
+            suite.runStorage();
+            suite.print(cout);
+            if (opt.has("csv")) suite.writeCsv(opt.get("csv", "bench_results.csv"));
+        }
+        return 0;
+    }
+
+    if (command == "replica") {
+        // read-only replica of --primary <dir> (default: the data directory); runs script commands
+        // from --script <file> or standard input against an in-memory copy kept current from the log
+        CommandOptions opt(argc, argv, 2);
+        shared_ptr<StorageEngine> primary = opt.has("primary") ? make_shared<FileEngine>(opt.get("primary", "")) : StorageEngine::standard();
+        if (primary->size("persons.dat") < 0) {
+            cout << "[ERROR] No data files to replicate.\n";
+            return 1;
+        }
+        shared_ptr<StorageEngine> local = make_shared<MemoryEngine>();
+        ChangeCursor start = ReplicaFollower::snapshot(*primary, *local);
+        DataManager dm(local);
+        dm.setChangeCapture(false);
+        ReplicaFollower follower(*primary, dm, start);
+        follower.poll();
+        cout << "Replica at change " << follower.position() << ".\n";
+        follower.start(max(10, opt.getInt("interval", 500)));
+        ScriptRunner runner(dm);
+        runner.setReplica(follower.lock);
+        string path = opt.get("script", "-");
+        int failed = 0;
+        if (path == "-") failed = runner.run(cin, "<stdin>");
+        else {
+            ifstream script(path);
+            if (!script) {
+                cout << "[ERROR] Could not open script " << path << endl;
+                return 1;
+            }
+            failed = runner.run(script, path);
+        }
+        follower.stop();
+        return failed == 0 ? 0 : 1;
+    }
+    if (command == "tail-changes") {
+        // one line per event: sequence, kind, table, record id (cutoff date for archive), record bytes
+        CommandOptions opt(argc, argv, 2);
+        StorageEngine& storage = *StorageEngine::standard();
+        ChangeCursor cursor = ChangeLog::seek(storage, (uint64_t)atoll(opt.get("from", "0").c_str()));
+        int interval = max(10, opt.getInt("interval", 500));
+        vector<ChangeEvent> events;
+        while (true) {
+            events.clear();
+            if (ChangeLog::read(storage, cursor, events) == 0) {
+                if (!opt.has("follow")) break;
+                this_thread::sleep_for(chrono::milliseconds(interval));
+                continue;
+            }
+            for (const auto& e : events) {
+                cout << e.sequence << '\t' << changeKindName(e.kind) << '\t' << changeTableName(e.table) << '\t';
+                if (e.kind == ChangeKind::Archive) cout << Date::fromKey(e.id).toString();
+                else cout << e.id;
+                cout << '\t' << e.record.size() << '\n';
+            }
+            cout.flush();
+        }
+        return 0;
+    }
+    if (command == "search") {
+        // search <text> [--in person|course|room|building] [--limit N]
+        if (argc < 3 || string(argv[2]).rfind("--", 0) == 0) {
+            cout << "Usage: " << argv[0] << " search <text> [--in person|course|room|building] [--limit N]\n";
+            return 1;
+        }
+        CommandOptions opt(argc, argv, 3);
+        ChangeTable only = (ChangeTable)0;
+        if (opt.has("in")) {
+            string table = opt.get("in", "");
+            for (ChangeTable t : { ChangeTable::Person, ChangeTable::Course, ChangeTable::Room, ChangeTable::Building }) {
+                if (table == changeTableName(t)) only = t;
+            }
+            if (only == (ChangeTable)0) {
+                cout << "[ERROR] --in takes person, course, room or building.\n";
+                return 1;
+            }
+        }
+        DataManager dm;
+        auto begin = chrono::steady_clock::now();
+        vector<SearchIndex::Hit> hits = dm.search(argv[2], (size_t)max(1, opt.getInt("limit", 10)), only);
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count();
+        cout << LabManagementSystem::printSearchHits(dm, hits) << hits.size() << " match(es) among "
+            << dm.searchableRecords() << " records in " << fixed << setprecision(1) << micros << " us\n";
+        return 0;
+    }
+    if (command == "record") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " record <session-file>\n";
+            return 1;
+        }
+        ofstream sessionLog(argv[2]);
+        if (!sessionLog) {
+            cout << "[ERROR] Could not create " << argv[2] << endl;
+            return 1;
+        }
+        DataManager dm;
+        InputRecorder recorder(cin, sessionLog);
+        istream recordedInput(&recorder);
+        LabManagementSystem app(dm, recordedInput, cout);
+        app.run();
+        return 0;
+    }
+    if (command == "replay") {
+        // sessions run against an in-memory copy, so every replay starts from the same data and
+        // nothing they change is saved
+        CommandOptions opt(argc, argv, 2);
+        shared_ptr<StorageEngine> copy = make_shared<MemoryEngine>();
+        DataManager(StorageEngine::standard()).copyFilesTo(*copy);
+        DataManager dm(copy);
+        ReplayDriver driver(dm, atof(opt.get("speed", "0").c_str()));
+        int loaded = 0;
+        for (int i = 2; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg.rfind("--", 0) == 0) { ++i; continue; }
+            if (!driver.loadSession(arg)) {
+                cout << "[ERROR] Could not read session " << arg << endl;
+                return 1;
+            }
+            loaded++;
+        }
+        if (loaded == 0) {
+            cout << "Usage: " << argv[0] << " replay <session-file>... [--copies N] [--speed X] [--csv file]\n";
+            return 1;
+        }
+        driver.run(max(1, opt.getInt("copies", 1)), cout, opt.get("csv", ""));
+        return 0;
+    }
+
+    DataManager dm;
+    LabManagementSystem app(dm);
     app.run();
 
     return 0;